@@ -0,0 +1,507 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "archive.h"
+//Design archive: nearest saved designs to a spec, from the *_results.txt files the converters append to.
+//Each file is read once and then only from where the last refresh stopped, so a design saved from the
+//converter menus is picked up on the next visit without reading the archive again. New records go to a tail that is searched linearly until it is big
+//enough to be worth a tree. Then only the recent tree is rebuilt, unless it has grown to 1/8 of the
+//main tree and both are merged, so an insert costs O(log n) amortised and a query stays two tree walks.
+
+#define ARCHIVE_SHOW 20       // matches printed by the menu
+
+typedef struct {
+    const archive_index *index;
+    const double *key;
+    int k;
+    int found;
+    archive_match *best;      // sorted by distance, squared while searching
+} archive_knn;
+
+typedef struct {
+    const archive_index *index;
+    const double *key;
+    double radius;            // half width of the box on every axis, in decades
+    archive_match *match;     // max-heap by distance of the nearest min(found, max) so far
+    long max;
+    long found;
+} archive_box;
+
+static const char *const archive_files[] = {"buck_results.txt", "boost_results.txt", "buck_boost_results.txt", "cuk_results.txt"};
+static const char *const archive_tags[] = {"BUCK,", "BOOST,", "BUCK-BOOST,", "CUK,"};
+
+//The menu keeps its archives for the whole session, so each visit only reads what was saved since
+static archive_index archives[4];
+static int archives_ready = 0;
+
+static int  archive_parse(converter_type type, const char *line, double key[ARCHIVE_DIMS]);
+static int  archive_field(const char **next, const char *name, double *value);
+static int  archive_append(archive_index *index, const double key[ARCHIVE_DIMS], long offset);
+static void archive_rebuild(archive_index *index);
+static void archive_build(archive_record *record, long lo, long hi);
+static int  archive_widest(const archive_record *record, long lo, long hi);
+static void archive_select(archive_record *record, long lo, long hi, long nth, int dim);
+static void archive_knn_visit(archive_knn *knn, long i);
+static void archive_knn_search(archive_knn *knn, long lo, long hi);
+static void archive_box_visit(archive_box *box, long i);
+static void archive_box_search(archive_box *box, long lo, long hi);
+static void archive_heap_push(archive_match *heap, long n, archive_match match);
+static void archive_heap_replace(archive_match *heap, long n, archive_match match);
+static double archive_distance2(const double *a, const double *b);
+static int  archive_match_compare(const void *a, const void *b);
+static void archive_print_matches(const archive_index *index, const archive_match *match, long shown);
+static double elapsed_us(const struct timespec *start, const struct timespec *end);
+static int  archive_read_value(const char *prompt, double *value);
+
+void design_archive(void) {
+    int choice = 0;
+    converter_input input = {0};
+    double key[ARCHIVE_DIMS];
+
+    printf("\n>> Design Archive\n");
+    if (!archives_ready) {
+        for (int t = 0; t < 4; t++) {archive_init(&archives[t], (converter_type)t, archive_files[t]);}
+        archives_ready = 1;
+    }
+    for (int t = 0; t < 4; t++) {
+        long added = archive_refresh(&archives[t]);
+        printf("%-24s %ld designs", archive_files[t], archives[t].count);
+        if (added > 0) {printf(" (%ld new)", added);}
+        if (archives[t].skipped) {printf(", %ld lines skipped", archives[t].skipped);}
+        printf("\n");
+    }
+
+    printf("Select topology (1 = Buck, 2 = Boost, 3 = Buck-Boost, 4 = Cuk): ");
+    if (scanf("%d", &choice) != 1 || choice < 1 || choice > 4) {
+        printf("\nInvalid topology\n");
+        return;
+    }
+    archive_index *index = &archives[choice - 1];
+    input.type = (converter_type)(choice - 1);
+    if (!archive_read_value("Enter minimum input voltage: ", &input.vin_min)
+        || !archive_read_value("Enter maximum input voltage: ", &input.vin_max)
+        || !archive_read_value("Enter output voltage magnitude (positive value): ", &input.v_out)
+        || !archive_read_value("Enter output power: ", &input.p_out)
+        || !archive_read_value("Enter switching frequency: ", &input.f_switch)) {
+        return;
+    }
+    if (!(input.vin_min > 0 && input.vin_max > 0 && input.v_out > 0 && input.p_out > 0 && input.f_switch > 0)) {
+        printf("ERROR: All values must be positive!\n");
+        return;
+    }
+    if (index->count == 0) {
+        printf("No %s designs in the archive yet.\n", archive_tags[choice - 1]);
+        return;
+    }
+    archive_key(&input, key);
+
+    int search = 0;
+    printf("Search (1 = k nearest, 2 = within tolerance): ");
+    if (scanf("%d", &search) != 1) {
+        printf("\nInvalid input\n");
+        return;
+    }
+    struct timespec start, end;
+    if (search == 1) {
+        int k = 0;
+        archive_match match[ARCHIVE_MAX_K];
+        printf("Enter number of designs (1-%d): ", ARCHIVE_MAX_K);
+        if (scanf("%d", &k) != 1 || k < 1 || k > ARCHIVE_MAX_K) {
+            printf("ERROR: Number of designs must be 1 to %d!\n", ARCHIVE_MAX_K);
+            return;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        int found = archive_nearest(index, key, k, match);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        printf("\n%d nearest of %ld in %.1f us (distance in decades of Vin_min, Vin_max, Vout, Pout, f_sw):\n",
+               found, index->count, elapsed_us(&start, &end));
+        archive_print_matches(index, match, found);
+    }
+    else if (search == 2) {
+        double tolerance = 0;
+        archive_match match[ARCHIVE_SHOW];
+        printf("Enter tolerance on every value (%%): ");
+        if (scanf("%lf", &tolerance) != 1 || !(tolerance > 0)) {
+            printf("ERROR: Tolerance must be positive!\n");
+            return;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long found = archive_range(index, key, tolerance/100.0, match, ARCHIVE_SHOW);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        long shown = found < ARCHIVE_SHOW ? found : ARCHIVE_SHOW;
+        printf("\n%ld of %ld within %.1f %% in %.1f us", found, index->count, tolerance, elapsed_us(&start, &end));
+        if (shown < found) {printf(", showing the nearest %ld", shown);}
+        printf(":\n");
+        qsort(match, (size_t)shown, sizeof(match[0]), archive_match_compare);
+        archive_print_matches(index, match, shown);
+    }
+    else {
+        printf("ERROR: Invalid search!\n");
+    }
+}
+
+static int archive_read_value(const char *prompt, double *value) {
+    printf("%s", prompt);
+    if (scanf("%lf", value) != 1) {
+        printf("\nInvalid input\n");
+        return 0;
+    }
+    return 1;
+}
+
+void archive_init(archive_index *index, converter_type type, const char *path) {
+    memset(index, 0, sizeof(*index));
+    index->type = type;
+    snprintf(index->path, sizeof(index->path), "%s", path);
+}
+
+void archive_free(archive_index *index) {
+    free(index->record);
+    index->record = NULL;
+    index->count = index->cap = index->built = index->recent = 0;
+    index->file_bytes = index->skipped = 0;
+}
+
+//Ingest the lines appended since the last refresh. A file that shrank was replaced and is read again.
+//Return the number of new records, -1 if the file cannot be read or memory runs out.
+long archive_refresh(archive_index *index) {
+    FILE *fp = fopen(index->path, "rb");
+    char line[ARCHIVE_LINE];
+    double key[ARCHIVE_DIMS];
+    long added = 0;
+
+    if (!fp) {
+        //No saves for this topology yet
+        return 0;
+    }
+    fseek(fp, 0, SEEK_END);
+    if (ftell(fp) < index->file_bytes) {
+        archive_free(index);
+    }
+    fseek(fp, index->file_bytes, SEEK_SET);
+
+    long offset = index->file_bytes;
+    while (fgets(line, sizeof(line), fp)) {
+        size_t length = strlen(line);
+        if (length == 0) {break;}
+        if (line[length - 1] != '\n') {
+            if (feof(fp)) {break;}   // half written line, read it next time
+            //Longer than any saved design: skip the rest of it, once it is all there
+            int c;
+            while ((c = fgetc(fp)) != '\n' && c != EOF) {length++;}
+            if (c == EOF) {break;}
+            length++;
+            index->skipped++;
+        }
+        else if (archive_parse(index->type, line, key)) {
+            if (!archive_append(index, key, offset)) {
+                fclose(fp);
+                return -1;
+            }
+            added++;
+        }
+        else if (length > 1) {
+            index->skipped++;
+        }
+        offset += (long)length;
+        index->file_bytes = offset;
+    }
+    fclose(fp);
+    //One rebuild for the whole batch
+    if (index->count - index->recent > ARCHIVE_TAIL) {
+        archive_rebuild(index);
+    }
+    return added;
+}
+
+void archive_key(const converter_input *input, double key[ARCHIVE_DIMS]) {
+    key[0] = log10(input->vin_min);
+    key[1] = log10(input->vin_max);
+    key[2] = log10(input->v_out);
+    key[3] = log10(input->p_out);
+    key[4] = log10(input->f_switch);
+}
+
+//k nearest records, closest first. Return how many were found (fewer than k if the archive is small).
+int archive_nearest(const archive_index *index, const double key[ARCHIVE_DIMS], int k, archive_match *match) {
+    archive_knn knn = {index, key, k, 0, match};
+    if (k < 1) {
+        return 0;
+    }
+    archive_knn_search(&knn, 0, index->built);
+    archive_knn_search(&knn, index->built, index->recent);
+    for (long i = index->recent; i < index->count; i++) {
+        archive_knn_visit(&knn, i);
+    }
+    for (int i = 0; i < knn.found; i++) {
+        match[i].distance = sqrt(match[i].distance);
+    }
+    return knn.found;
+}
+
+//Records with every value within a factor (1 + tolerance) of the spec. The nearest max of them are
+//stored in match, in no particular order, the return value is the total.
+long archive_range(const archive_index *index, const double key[ARCHIVE_DIMS], double tolerance, archive_match *match, long max) {
+    archive_box box = {index, key, log10(1.0 + tolerance), match, max, 0};
+    archive_box_search(&box, 0, index->built);
+    archive_box_search(&box, index->built, index->recent);
+    for (long i = index->recent; i < index->count; i++) {
+        archive_box_visit(&box, i);
+    }
+    return box.found;
+}
+
+//Read the saved line of a record, without the newline. Return 0 if the file cannot be read.
+int archive_read_line(const archive_index *index, long record, char *line, int size) {
+    FILE *fp = fopen(index->path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    int ok = fseek(fp, index->record[record].offset, SEEK_SET) == 0 && fgets(line, size, fp) != NULL;
+    fclose(fp);
+    if (ok) {line[strcspn(line, "\r\n")] = '\0';}
+    return ok;
+}
+
+//Parse the spec of one saved line, e.g. "BUCK, Vin_min=50.000, Vin_max=60.000, Vout=24.000, Pout=800.000, f_sw=100000, ..."
+//Buck-boost and cuk save |Vout|.
+static int archive_parse(converter_type type, const char *line, double key[ARCHIVE_DIMS]) {
+    converter_input input = {0};
+    if (strncmp(line, archive_tags[type], strlen(archive_tags[type])) != 0) {
+        return 0;
+    }
+    //Fields in the order they are saved, each search starts where the last one stopped
+    const char *next = line;
+    if (!archive_field(&next, "Vin_min=", &input.vin_min) ||
+        !archive_field(&next, "Vin_max=", &input.vin_max) ||
+        !archive_field(&next, "Vout", &input.v_out) ||
+        !archive_field(&next, "Pout=", &input.p_out) ||
+        !archive_field(&next, "f_sw=", &input.f_switch)) {
+        return 0;
+    }
+    if (input.vin_min <= 0 || input.vin_max <= 0 || input.v_out <= 0 || input.p_out <= 0 || input.f_switch <= 0) {
+        return 0;
+    }
+    archive_key(&input, key);
+    return 1;
+}
+
+//Read the number after name, skipping a "|=" so "Vout" matches both "Vout=" and "|Vout|="
+static int archive_field(const char **next, const char *name, double *value) {
+    const char *field = strstr(*next, name);
+    char *end;
+    if (!field) {
+        return 0;
+    }
+    field += strlen(name);
+    field += strspn(field, "|=");
+    *value = strtod(field, &end);
+    *next = end;
+    return end != field;
+}
+
+static int archive_append(archive_index *index, const double key[ARCHIVE_DIMS], long offset) {
+    if (index->count == index->cap) {
+        long cap = index->cap ? index->cap*2 : 1024;
+        archive_record *record = realloc(index->record, (size_t)cap*sizeof(*record));
+        if (!record) {
+            return 0;
+        }
+        index->record = record;
+        index->cap = cap;
+    }
+    archive_record *record = &index->record[index->count++];
+    memcpy(record->key, key, sizeof(record->key));
+    record->offset = offset;
+    return 1;
+}
+
+static void archive_rebuild(archive_index *index) {
+    if (index->count - index->built > index->built/8) {
+        archive_build(index->record, 0, index->count);
+        index->built = index->count;
+    }
+    else {
+        archive_build(index->record, index->built, index->count);
+    }
+    index->recent = index->count;
+}
+
+//Implicit k-d tree: the median of [lo, hi) on the axis where the subtree is widest sits in the middle,
+//smaller or equal keys left of it, larger or equal right of it. The spec axes are strongly correlated
+//(Vout follows Vin), so the widest axis prunes much better than cycling through them.
+static void archive_build(archive_record *record, long lo, long hi) {
+    while (hi - lo > 1) {
+        long mid = lo + (hi - lo)/2;
+        int dim = archive_widest(record, lo, hi);
+        archive_select(record, lo, hi, mid, dim);
+        record[mid].split = dim;
+        archive_build(record, lo, mid);
+        lo = mid + 1;
+    }
+    if (hi - lo == 1) {record[lo].split = 0;}
+}
+
+//Widest axis of [lo, hi), from at most 256 evenly spaced records
+static int archive_widest(const archive_record *record, long lo, long hi) {
+    double min[ARCHIVE_DIMS], max[ARCHIVE_DIMS];
+    int widest = 0;
+    long step = (hi - lo)/256 + 1;
+    for (int d = 0; d < ARCHIVE_DIMS; d++) {min[d] = max[d] = record[lo].key[d];}
+    for (long i = lo + step; i < hi; i += step) {
+        for (int d = 0; d < ARCHIVE_DIMS; d++) {
+            if (record[i].key[d] < min[d]) {min[d] = record[i].key[d];}
+            if (record[i].key[d] > max[d]) {max[d] = record[i].key[d];}
+        }
+    }
+    for (int d = 1; d < ARCHIVE_DIMS; d++) {
+        if (max[d] - min[d] > max[widest] - min[widest]) {widest = d;}
+    }
+    return widest;
+}
+
+//Quickselect: put the nth smallest key on axis dim at nth, partitioned around it
+static void archive_select(archive_record *record, long lo, long hi, long nth, int dim) {
+    hi--;
+    while (hi > lo) {
+        //Median of three as pivot
+        long mid = lo + (hi - lo)/2;
+        double a = record[lo].key[dim], b = record[mid].key[dim], c = record[hi].key[dim];
+        double pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+        long i = lo, j = hi;
+        while (i <= j) {
+            while (record[i].key[dim] < pivot) {i++;}
+            while (record[j].key[dim] > pivot) {j--;}
+            if (i <= j) {
+                archive_record swap = record[i];
+                record[i] = record[j];
+                record[j] = swap;
+                i++;
+                j--;
+            }
+        }
+        if (nth <= j) {hi = j;}
+        else if (nth >= i) {lo = i;}
+        else {break;}
+    }
+}
+
+static void archive_knn_visit(archive_knn *knn, long i) {
+    double d2 = archive_distance2(knn->index->record[i].key, knn->key);
+    if (knn->found == knn->k && d2 >= knn->best[knn->k - 1].distance) {
+        return;
+    }
+    //Insertion into the sorted list, the worst one drops off when it is full
+    int j = knn->found < knn->k ? knn->found++ : knn->k - 1;
+    while (j > 0 && knn->best[j - 1].distance > d2) {
+        knn->best[j] = knn->best[j - 1];
+        j--;
+    }
+    knn->best[j].record = i;
+    knn->best[j].distance = d2;
+}
+
+static void archive_knn_search(archive_knn *knn, long lo, long hi) {
+    while (lo < hi) {
+        long mid = lo + (hi - lo)/2;
+        int dim = knn->index->record[mid].split;
+        double diff = knn->key[dim] - knn->index->record[mid].key[dim];
+        archive_knn_visit(knn, mid);
+        //Nearer side first, the far side only if the splitting plane is closer than the worst match
+        if (diff < 0) {
+            archive_knn_search(knn, lo, mid);
+            if (knn->found == knn->k && diff*diff >= knn->best[knn->k - 1].distance) {return;}
+            lo = mid + 1;
+        }
+        else {
+            archive_knn_search(knn, mid + 1, hi);
+            if (knn->found == knn->k && diff*diff >= knn->best[knn->k - 1].distance) {return;}
+            hi = mid;
+        }
+    }
+}
+
+static void archive_box_visit(archive_box *box, long i) {
+    const double *key = box->index->record[i].key;
+    for (int d = 0; d < ARCHIVE_DIMS; d++) {
+        if (fabs(key[d] - box->key[d]) > box->radius) {return;}
+    }
+    archive_match match = {i, sqrt(archive_distance2(key, box->key))};
+    if (box->found < box->max) {
+        archive_heap_push(box->match, box->found, match);
+    }
+    else if (box->max > 0 && match.distance < box->match[0].distance) {
+        archive_heap_replace(box->match, box->max, match);
+    }
+    box->found++;
+}
+
+static void archive_box_search(archive_box *box, long lo, long hi) {
+    while (lo < hi) {
+        long mid = lo + (hi - lo)/2;
+        int dim = box->index->record[mid].split;
+        double split = box->index->record[mid].key[dim];
+        archive_box_visit(box, mid);
+        int left = box->key[dim] - box->radius <= split;
+        int right = box->key[dim] + box->radius >= split;
+        if (left && right) {
+            archive_box_search(box, lo, mid);
+            lo = mid + 1;
+        }
+        else if (left) {hi = mid;}
+        else {lo = mid + 1;}
+    }
+}
+
+//Binary max-heap on distance: the farthest of the kept matches is heap[0], the one a nearer match replaces
+static void archive_heap_push(archive_match *heap, long n, archive_match match) {
+    long i = n;
+    while (i > 0 && heap[(i - 1)/2].distance < match.distance) {
+        heap[i] = heap[(i - 1)/2];
+        i = (i - 1)/2;
+    }
+    heap[i] = match;
+}
+
+static void archive_heap_replace(archive_match *heap, long n, archive_match match) {
+    long i = 0;
+    for (;;) {
+        long child = 2*i + 1;
+        if (child >= n) {break;}
+        if (child + 1 < n && heap[child + 1].distance > heap[child].distance) {child++;}
+        if (heap[child].distance <= match.distance) {break;}
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = match;
+}
+
+static double archive_distance2(const double *a, const double *b) {
+    double d2 = 0;
+    for (int d = 0; d < ARCHIVE_DIMS; d++) {
+        d2 += (a[d] - b[d])*(a[d] - b[d]);
+    }
+    return d2;
+}
+
+static int archive_match_compare(const void *a, const void *b) {
+    double da = ((const archive_match *)a)->distance;
+    double db = ((const archive_match *)b)->distance;
+    return (da > db) - (da < db);
+}
+
+static void archive_print_matches(const archive_index *index, const archive_match *match, long shown) {
+    char line[ARCHIVE_LINE];
+    for (long i = 0; i < shown; i++) {
+        if (!archive_read_line(index, match[i].record, line, sizeof(line))) {
+            snprintf(line, sizeof(line), "(cannot read %s)", index->path);
+        }
+        printf("%3ld. d=%.4f  %s\n", i + 1, match[i].distance, line);
+    }
+}
+
+static double elapsed_us(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec)*1e6 + (end->tv_nsec - start->tv_nsec)/1e3;
+}
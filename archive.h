@@ -0,0 +1,46 @@
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+
+#include "funcs.h"
+
+#define ARCHIVE_DIMS   5      // Vin_min, Vin_max, Vout, Pout, f_sw
+#define ARCHIVE_MAX_K  64     // most neighbours one query returns
+#define ARCHIVE_TAIL   4096   // new records searched linearly before the tree is rebuilt
+#define ARCHIVE_LINE   1024
+
+//One saved design. The key is log10 of the spec, so a distance is a ratio and every axis weighs the same.
+typedef struct {
+    double key[ARCHIVE_DIMS];
+    long offset;              // of its line in the archive file
+    int split;                // axis this node splits its subtree on
+} archive_record;
+
+typedef struct {
+    long record;              // index into archive_index.record, valid until the next refresh
+    double distance;          // Euclidean, in decades
+} archive_match;
+
+//Archive of one topology, in three parts searched one after the other: record[0, built) is an implicit
+//k-d tree, record[built, recent) a smaller one of recent records and record[recent, count) the unsorted tail.
+typedef struct {
+    converter_type type;
+    char path[256];
+    archive_record *record;
+    long count;
+    long cap;
+    long built;
+    long recent;
+    long file_bytes;          // bytes of the file already ingested
+    long skipped;             // lines that could not be parsed
+} archive_index;
+
+void design_archive(void);
+void archive_init(archive_index *index, converter_type type, const char *path);
+void archive_free(archive_index *index);
+long archive_refresh(archive_index *index);
+void archive_key(const converter_input *input, double key[ARCHIVE_DIMS]);
+int  archive_nearest(const archive_index *index, const double key[ARCHIVE_DIMS], int k, archive_match *match);
+long archive_range(const archive_index *index, const double key[ARCHIVE_DIMS], double tolerance, archive_match *match, long max);
+int  archive_read_line(const archive_index *index, long record, char *line, int size);
+
+#endif
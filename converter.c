@@ -0,0 +1,260 @@
+#include <string.h>
+#include <math.h>
+#include "converter.h"
+#include "converter_eq.h"
+//Design equations for all four topologies, moved out of funcs.c so they can be built as a library.
+//No I/O and no globals here: warnings and errors are returned as CONV_ bits and printed by funcs.c.
+//The equations themselves are in converter_eq.h, tweak.c evaluates the same ones field by field.
+
+static unsigned buck_validate(const converter_input *input);
+static void buck_calculate(const converter_input *input, converter_result *result);
+static unsigned buck_analyse(const converter_input *input, converter_result *result);
+static unsigned buck_warnings(const converter_input *input, const converter_result *result);
+
+static unsigned boost_validate(const converter_input *input);
+static void boost_calculate(const converter_input *input, converter_result *result);
+static unsigned boost_analyse(const converter_input *input, converter_result *result);
+static unsigned boost_warnings(const converter_input *input, const converter_result *result);
+
+static unsigned buck_boost_validate(const converter_input *input);
+static void buck_boost_calculate(const converter_input *input, converter_result *result);
+static unsigned buck_boost_analyse(const converter_input *input, converter_result *result);
+static unsigned buck_boost_warnings(const converter_input *input, const converter_result *result);
+
+static unsigned cuk_validate(const converter_input *input);
+static void cuk_calculate(const converter_input *input, converter_result *result);
+static unsigned cuk_analyse(const converter_input *input, converter_result *result);
+static unsigned cuk_warnings(const converter_input *input, const converter_result *result);
+
+int converter_api_version(void) {
+    return CONVERTER_API_VERSION;
+}
+
+size_t design(const converter_input *input, converter_result *result, size_t n, unsigned flags, unsigned *diag) {
+    size_t rejected = 0;
+    for (size_t i = 0; i < n; i++) {
+        unsigned bits = 0;
+        if (!(flags & CONV_NO_VALIDATE)) {
+            bits = converter_validate(&input[i]);
+        }
+        if (bits & CONV_ERR_MASK) {
+            memset(&result[i], 0, sizeof(result[i]));
+            rejected++;
+        }
+        else {
+            converter_calculate(&input[i], &result[i]);
+            if (!(flags & CONV_NO_ANALYSE)) {
+                switch (input[i].type) {
+                    case buck_conv:       bits |= buck_analyse(&input[i], &result[i]); break;
+                    case boost_conv:      bits |= boost_analyse(&input[i], &result[i]); break;
+                    case buck_boost_conv: bits |= buck_boost_analyse(&input[i], &result[i]); break;
+                    case cuk_conv:        bits |= cuk_analyse(&input[i], &result[i]); break;
+                }
+            }
+        }
+        if (diag) {diag[i] = bits;}
+    }
+    return rejected;
+}
+
+unsigned converter_validate(const converter_input *input) {
+    switch (input->type) {
+        case buck_conv:       return buck_validate(input);
+        case boost_conv:      return boost_validate(input);
+        case buck_boost_conv: return buck_boost_validate(input);
+        case cuk_conv:        return cuk_validate(input);
+    }
+    return CONV_ERR_TYPE;
+}
+
+unsigned converter_warnings(const converter_input *input, const converter_result *result) {
+    switch (input->type) {
+        case buck_conv:       return buck_warnings(input, result);
+        case boost_conv:      return boost_warnings(input, result);
+        case buck_boost_conv: return buck_boost_warnings(input, result);
+        case cuk_conv:        return cuk_warnings(input, result);
+    }
+    return 0;
+}
+
+void converter_calculate(const converter_input *input, converter_result *result) {
+    switch (input->type) {
+        case buck_conv:
+            buck_calculate(input, result);
+            break;
+        case boost_conv:
+            boost_calculate(input, result);
+            break;
+        case buck_boost_conv:
+            buck_boost_calculate(input, result);
+            break;
+        case cuk_conv:
+            cuk_calculate(input, result);
+            break;
+    }
+}
+
+//Checks shared by every topology. NaN passes every <= and > test, so non-finite values are caught first.
+static unsigned common_validate(const converter_input *input) {
+    unsigned diag = 0;
+    if (!isfinite(input->vin_min) || !isfinite(input->vin_max) || !isfinite(input->v_out) || !isfinite(input->p_out)
+        || !isfinite(input->f_switch) || !isfinite(input->ripple_v_percent)) {diag |= CONV_ERR_NONFINITE;}
+    if (input->vin_min <= 0 || input->vin_max <= 0 || input->v_out <= 0) {diag |= CONV_ERR_VOLTAGE;}
+    if (input->vin_min > input->vin_max) {diag |= CONV_ERR_VIN_RANGE;}
+    if (input->p_out <= 0) {diag |= CONV_ERR_POWER;}
+    if (input->f_switch <= 0) {diag |= CONV_ERR_FREQUENCY;}
+    if (input->ripple_v_percent <= 0 || input->ripple_v_percent > 100) {diag |= CONV_ERR_RIPPLE_V;}
+    return diag;
+}
+
+//BUCK CONVERTER
+static unsigned buck_validate(const converter_input *input) {
+    unsigned diag = common_validate(input);
+    //Check if vin_min < v_out. Buck is a stepdown converter
+    if (input->v_out >= input->vin_min) {diag |= CONV_ERR_STEP;}
+    if (!isfinite(input->ripple_i_percent)) {diag |= CONV_ERR_NONFINITE;}
+    if (input->ripple_i_percent <= 0 || input->ripple_i_percent > 100) {diag |= CONV_ERR_RIPPLE_I;}
+    return diag;
+}
+
+static void buck_calculate(const converter_input *input, converter_result *result) {
+    result->duty_cycle = buck_eq_d(input, result);
+    result->r_load = buck_eq_r(input, result);
+    //I out = Vout/Rload
+    result->i_out = buck_eq_iout(input, result);
+    result->ripple_i_L = buck_eq_dil(input, result);
+    result->L = buck_eq_l(input, result);
+    //Capacitance. Equation from 2501
+    result->ripple_v_C = buck_eq_dvc(input, result);
+    result->C = buck_eq_c(input, result);
+}
+
+static unsigned buck_analyse(const converter_input *input, converter_result *result) {
+    //Check boundary condition dcm and ccm using i LB
+    result->i_LB = buck_eq_ilb(input, result);
+    //Check ccm 1 or 0
+    result->is_ccm = (int)buck_eq_ccm(input, result);
+    //i_L peak
+    result->i_L_peak = buck_eq_peak(input, result);
+    return buck_warnings(input, result);
+}
+
+static unsigned buck_warnings(const converter_input *input, const converter_result *result) {
+    unsigned diag = 0;
+    //Warning for DCM, high ripple current and volatge. Industry use.
+    if (!result->is_ccm) {diag |= CONV_WARN_DCM;}
+    if (result->ripple_i_L > 0.4*result->i_out) {diag |= CONV_WARN_RIPPLE_I;}
+    if (input->ripple_v_percent > 5.0) {diag |= CONV_WARN_RIPPLE_V;}
+    return diag;
+}
+
+//Boost converter
+static unsigned boost_validate(const converter_input *input) {
+    unsigned diag = common_validate(input);
+    // Boost is step-up: Vout > Vin_max
+    if (input->v_out <= input->vin_max) {diag |= CONV_ERR_STEP;}
+    if (!isfinite(input->ripple_i_percent)) {diag |= CONV_ERR_NONFINITE;}
+    if (input->ripple_i_percent <= 0 || input->ripple_i_percent > 100) {diag |= CONV_ERR_RIPPLE_I;}
+    return diag;
+}
+
+static void boost_calculate(const converter_input *input, converter_result *result) {
+    //Equation from ELEC2501
+    result->duty_cycle = boost_eq_d(input, result);
+    result->r_load = boost_eq_r(input, result);
+    result->i_out = boost_eq_iout(input, result);
+    result->ripple_i_L = boost_eq_dil(input, result);
+    result->L = boost_eq_l(input, result);
+    result->ripple_v_C = boost_eq_dvc(input, result);
+    result->C = boost_eq_c(input, result);
+}
+
+static unsigned boost_analyse(const converter_input *input, converter_result *result) {
+    result->i_LB = boost_eq_ilb(input, result);
+    result->is_ccm = (int)boost_eq_ccm(input, result);
+    result->i_L_peak = boost_eq_peak(input, result);
+    return boost_warnings(input, result);
+}
+
+static unsigned boost_warnings(const converter_input *input, const converter_result *result) {
+    unsigned diag = 0;
+    if (!result->is_ccm) {diag |= CONV_WARN_DCM;}
+    if (input->ripple_i_percent > 40) {diag |= CONV_WARN_RIPPLE_I;}
+    if (input->ripple_v_percent > 5.0) {diag |= CONV_WARN_RIPPLE_V;}
+    return diag;
+}
+
+//Buck_Boost Converter
+static unsigned buck_boost_validate(const converter_input *input) {
+    //buck_boost converter can be step up or step down converter so no need to check relation between vin and vout
+    unsigned diag = common_validate(input);
+    if (!isfinite(input->ripple_i_percent)) {diag |= CONV_ERR_NONFINITE;}
+    if (input->ripple_i_percent <= 0 || input->ripple_i_percent > 100) {diag |= CONV_ERR_RIPPLE_I;}
+    return diag;
+}
+
+static void buck_boost_calculate(const converter_input *input, converter_result *result) {
+    //Equation from 2501
+    result->duty_cycle = buck_boost_eq_d(input, result);
+    result->i_out = buck_boost_eq_iout(input, result);
+    result->r_load = buck_boost_eq_r(input, result);
+    result->ripple_i_L = buck_boost_eq_dil(input, result);
+    result->L = buck_boost_eq_l(input, result);
+    result->ripple_v_C = buck_boost_eq_dvc(input, result);
+    result->C = buck_boost_eq_c(input, result);
+}
+
+static unsigned buck_boost_analyse(const converter_input *input, converter_result *result) {
+    result->i_LB = buck_boost_eq_ilb(input, result);
+    result->i_L_peak = buck_boost_eq_peak(input, result);
+    result->is_ccm = (int)buck_boost_eq_ccm(input, result);
+    return buck_boost_warnings(input, result);
+}
+
+static unsigned buck_boost_warnings(const converter_input *input, const converter_result *result) {
+    unsigned diag = 0;
+    if (!result->is_ccm) {diag |= CONV_WARN_DCM;}
+    if (input->ripple_i_percent > 40.0) {diag |= CONV_WARN_RIPPLE_I;}
+    if (input->ripple_v_percent > 5.0) {diag |= CONV_WARN_RIPPLE_V;}
+    return diag;
+}
+
+//CUK CONVERTER
+static unsigned cuk_validate(const converter_input *input) {
+    unsigned diag = common_validate(input);
+    if (!isfinite(input->ripple_i_1_percent) || !isfinite(input->ripple_i_2_percent)
+        || !isfinite(input->ripple_v_cn_percent)) {diag |= CONV_ERR_NONFINITE;}
+    //L1, L2 and Cn: 0–100%
+    if (input->ripple_i_1_percent <= 0 || input->ripple_i_1_percent > 100) {diag |= CONV_ERR_RIPPLE_I;}
+    if (input->ripple_i_2_percent <= 0 || input->ripple_i_2_percent > 100) {diag |= CONV_ERR_RIPPLE_I_2;}
+    if (input->ripple_v_cn_percent <= 0 || input->ripple_v_cn_percent > 100) {diag |= CONV_ERR_RIPPLE_CN;}
+    return diag;
+}
+
+static void cuk_calculate(const converter_input *input, converter_result *result) {
+    //equation from 2501
+    result->duty_cycle = cuk_eq_d(input, result);
+    result->r_load = cuk_eq_r(input, result);
+    result->i_out = cuk_eq_iout(input, result);
+    result->L1 = cuk_eq_l1(input, result);
+    result->L2 = cuk_eq_l2(input, result);
+    result->Co = cuk_eq_co(input, result);
+    result->Cn = cuk_eq_cn(input, result);
+}
+
+static unsigned cuk_analyse(const converter_input *input, converter_result *result) {
+    //worst delta IL and IL to detect ccm or dcm
+    result->i_LB = cuk_eq_ilb(input, result);
+    result->i_L_peak = cuk_eq_peak(input, result);
+    result->is_ccm = (int)cuk_eq_ccm(input, result);
+    return cuk_warnings(input, result);
+}
+
+static unsigned cuk_warnings(const converter_input *input, const converter_result *result) {
+    unsigned diag = 0;
+    if (!result->is_ccm) {diag |= CONV_WARN_DCM;}
+    if (input->ripple_i_1_percent > 40.0 || input->ripple_i_2_percent > 40.0) {diag |= CONV_WARN_RIPPLE_I;}
+    if (input->ripple_v_percent > 5.0) {diag |= CONV_WARN_RIPPLE_V;}
+    if (input->ripple_v_cn_percent > 10.0) {diag |= CONV_WARN_RIPPLE_CN;}
+    return diag;
+}
@@ -0,0 +1,97 @@
+#ifndef CONVERTER_H
+#define CONVERTER_H
+//libconverter: the converter design equations without any I/O.
+//Every function is reentrant and keeps no state, so it can be called from any number of threads.
+//Build with "make lib" for libconverter.a and libconverter.so.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CONVERTER_API_VERSION 1
+
+typedef enum {
+    buck_conv = 0,
+    boost_conv,
+    buck_boost_conv,
+    cuk_conv
+} converter_type;
+
+//input for all converter
+typedef struct {
+    converter_type type;
+    double vin_min;
+    double vin_max;
+    double v_out;
+    double p_out;
+    double f_switch;
+    double ripple_i_percent;
+    double ripple_i_1_percent;// for cuk converter
+    double ripple_i_2_percent;// for cuk converter
+    double ripple_v_percent;
+    double ripple_v_cn_percent;//for cuk converter
+} converter_input;
+
+//output
+typedef struct {
+    double duty_cycle;
+    double r_load;
+    double i_out;
+    double ripple_i_L;
+    double ripple_v_C;
+    double L;
+    double C;
+    double L1;//for cuk converter
+    double L2;//for cuk converter
+    double Cn;//for cuk converter
+    double Co;//for cuk converter
+    double i_L_peak;
+    double i_LB; //for ccm/dcm
+    int is_ccm; // 1 = ccm, 0 = dcm
+} converter_result;
+
+//Diagnostics, one word per design. Any CONV_ERR_ bit means the input was rejected.
+#define CONV_ERR_VOLTAGE     0x0001u  // a voltage <= 0
+#define CONV_ERR_VIN_RANGE   0x0002u  // Vin_min > Vin_max
+#define CONV_ERR_STEP        0x0004u  // buck needs Vout < Vin_min, boost needs Vout > Vin_max
+#define CONV_ERR_POWER       0x0008u  // Pout <= 0
+#define CONV_ERR_FREQUENCY   0x0010u  // f_switch <= 0
+#define CONV_ERR_RIPPLE_I    0x0020u  // inductor ripple (L1 for cuk) not in (0, 100]
+#define CONV_ERR_RIPPLE_I_2  0x0040u  // cuk L2 ripple not in (0, 100]
+#define CONV_ERR_RIPPLE_V    0x0080u  // output voltage ripple not in (0, 100]
+#define CONV_ERR_RIPPLE_CN   0x0100u  // cuk Cn ripple not in (0, 100]
+#define CONV_ERR_TYPE        0x0200u  // unknown topology
+#define CONV_ERR_NONFINITE   0x0400u  // an input the topology uses is NaN or infinite
+#define CONV_ERR_MASK        0x0fffu
+#define CONV_WARN_DCM        0x1000u  // DCM at rated load
+#define CONV_WARN_RIPPLE_I   0x2000u  // inductor ripple > 40 %
+#define CONV_WARN_RIPPLE_V   0x4000u  // output voltage ripple > 5 %
+#define CONV_WARN_RIPPLE_CN  0x8000u  // cuk Cn ripple > 10 %
+
+//Flags for design()
+#define CONV_NO_VALIDATE     0x1u     // inputs are known to be valid, skip the checks
+#define CONV_NO_ANALYSE      0x2u     // calculators only: no i_LB, i_L_peak, is_ccm or warnings
+
+//Design n converters. result[i] is zeroed when input[i] is rejected.
+//diag may be NULL, otherwise diag[i] gets the CONV_ERR_/CONV_WARN_ bits of design i.
+//Return the number of rejected designs.
+size_t design(const converter_input *input, converter_result *result, size_t n, unsigned flags, unsigned *diag);
+
+//Validation only, the CONV_ERR_ bits of one design
+unsigned converter_validate(const converter_input *input);
+
+//Double precision calculators only, no validation or analysis
+void converter_calculate(const converter_input *input, converter_result *result);
+
+//The CONV_WARN_ bits of a designed converter, from its input and a result with i_LB and is_ccm filled in
+unsigned converter_warnings(const converter_input *input, const converter_result *result);
+
+int converter_api_version(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef CONVERTER_EQ_H
+#define CONVERTER_EQ_H
+
+#include "converter.h"
+//One function per result field of each topology, shared by converter.c and the tweak graphs in tweak.c
+//so both evaluate exactly the same expressions. A function only reads the input and the result
+//fields computed before it, in the order converter.c fills them in.
+
+//The expressions themselves, written once for any floating type T and instantiated below for double
+//(suffix _d, used by the functions of this file) and float (suffix _f, the float32 calculators in
+//precision.c). 1 - D is passed in as duty_off: double uses 1.0 - D, float32 uses Vin/(Vin + Vout)
+//because 1.0f - D cancels to nothing when Vout >> Vin.
+#define CONVERTER_EQ_SCALAR(T, S) \
+static inline T r_load_##S(T v_out, T p_out) {return (v_out*v_out)/p_out;} \
+static inline T i_out_##S(T p_out, T v_out) {return p_out/v_out;} \
+static inline T ripple_v_##S(T ripple_v_percent, T v_out) {return (ripple_v_percent/(T)100)*v_out;} \
+static inline T buck_duty_##S(T vin_min, T v_out) {return v_out/vin_min;} \
+static inline T buck_i_out_##S(T v_out, T r_load) {return v_out/r_load;} \
+static inline T buck_ripple_i_##S(T ripple_i_percent, T i_out) {return (ripple_i_percent/(T)100)*i_out;} \
+static inline T buck_l_##S(T vin_max, T v_out, T duty, T f, T ripple_i) {return (vin_max - v_out)*duty/(f*ripple_i);} \
+static inline T buck_c_##S(T ripple_i, T f, T ripple_v) {return ripple_i/((T)8*f*ripple_v);} \
+static inline T boost_duty_##S(T vin_min, T v_out) {return (T)1 - vin_min/v_out;} \
+static inline T boost_ripple_i_##S(T ripple_i_percent, T p_out, T vin_min) {return ripple_i_percent*(p_out/vin_min)/(T)100;} \
+static inline T boost_l_##S(T vin_min, T duty, T ripple_i, T f) {return vin_min*duty/(ripple_i*f);} \
+static inline T boost_c_##S(T i_out, T duty, T f, T ripple_v) {return (i_out*duty)/(f*ripple_v);} \
+static inline T buck_boost_duty_##S(T vin_min, T v_out) {return v_out/(vin_min + v_out);} \
+static inline T buck_boost_ripple_i_##S(T ripple_i_percent, T i_out, T duty_off) {return (ripple_i_percent/(T)100)*(i_out/duty_off);} \
+static inline T buck_boost_l_##S(T vin_min, T duty, T f, T ripple_i) {return vin_min*duty/(f*ripple_i);} \
+static inline T buck_boost_c_##S(T i_out, T duty, T ripple_v, T f) {return i_out*duty/(ripple_v*f);} \
+static inline T cuk_delta_il_1_##S(T p_out, T vin_min, T ripple_i_1_percent) {return (p_out/vin_min)*ripple_i_1_percent/(T)100;} \
+static inline T cuk_delta_il_2_##S(T i_out, T ripple_i_2_percent) {return i_out*ripple_i_2_percent/(T)100;} \
+static inline T cuk_l1_##S(T vin_min, T duty, T f, T delta_il_1) {return (vin_min*duty)/(f*delta_il_1);} \
+static inline T cuk_l2_##S(T v_out, T duty_off, T f, T delta_il_2) {return (v_out*duty_off)/(f*delta_il_2);} \
+static inline T cuk_co_##S(T v_out, T duty_off, T f, T ripple_v_percent, T L2) { \
+    return v_out*duty_off/((T)8*f*f*(v_out*ripple_v_percent/(T)100)*L2); \
+} \
+static inline T cuk_cn_##S(T i_out, T duty_off, T f, T vin_min, T ripple_v_cn_percent) { \
+    return (i_out*duty_off)/(f*(vin_min*ripple_v_cn_percent/(T)100)); \
+}
+
+CONVERTER_EQ_SCALAR(double, d)
+CONVERTER_EQ_SCALAR(float, f)
+
+//BUCK CONVERTER
+//K=Vout/Vin, vin_min for worst case
+static inline double buck_eq_d(const converter_input *in, const converter_result *r) {(void)r; return buck_duty_d(in->vin_min, in->v_out);}
+//Rload from P-out
+static inline double buck_eq_r(const converter_input *in, const converter_result *r) {(void)r; return r_load_d(in->v_out, in->p_out);}
+static inline double buck_eq_iout(const converter_input *in, const converter_result *r) {return buck_i_out_d(in->v_out, r->r_load);}
+static inline double buck_eq_dil(const converter_input *in, const converter_result *r) {return buck_ripple_i_d(in->ripple_i_percent, r->i_out);}
+//Inductor use vin max for worst case. Equation from 2501
+static inline double buck_eq_l(const converter_input *in, const converter_result *r) {return buck_l_d(in->vin_max, in->v_out, r->duty_cycle, in->f_switch, r->ripple_i_L);}
+static inline double buck_eq_dvc(const converter_input *in, const converter_result *r) {(void)r; return ripple_v_d(in->ripple_v_percent, in->v_out);}
+static inline double buck_eq_c(const converter_input *in, const converter_result *r) {return buck_c_d(r->ripple_i_L, in->f_switch, r->ripple_v_C);}
+static inline double buck_eq_ilb(const converter_input *in, const converter_result *r) {(void)in; return r->ripple_i_L/2.0;}
+static inline double buck_eq_peak(const converter_input *in, const converter_result *r) {(void)in; return r->i_out + r->ripple_i_L/2.0;}
+static inline double buck_eq_ccm(const converter_input *in, const converter_result *r) {(void)in; return r->i_out > r->i_LB;}
+
+//Boost converter, vin_min for worst case
+static inline double boost_eq_d(const converter_input *in, const converter_result *r) {(void)r; return boost_duty_d(in->vin_min, in->v_out);}
+static inline double boost_eq_r(const converter_input *in, const converter_result *r) {(void)r; return r_load_d(in->v_out, in->p_out);}
+static inline double boost_eq_iout(const converter_input *in, const converter_result *r) {(void)r; return i_out_d(in->p_out, in->v_out);}
+static inline double boost_eq_dil(const converter_input *in, const converter_result *r) {(void)r; return boost_ripple_i_d(in->ripple_i_percent, in->p_out, in->vin_min);}
+static inline double boost_eq_l(const converter_input *in, const converter_result *r) {return boost_l_d(in->vin_min, r->duty_cycle, r->ripple_i_L, in->f_switch);}
+static inline double boost_eq_dvc(const converter_input *in, const converter_result *r) {(void)r; return ripple_v_d(in->ripple_v_percent, in->v_out);}
+static inline double boost_eq_c(const converter_input *in, const converter_result *r) {return boost_c_d(r->i_out, r->duty_cycle, in->f_switch, r->ripple_v_C);}
+static inline double boost_eq_ilb(const converter_input *in, const converter_result *r) {(void)in; return r->ripple_i_L/2.0;}
+static inline double boost_eq_peak(const converter_input *in, const converter_result *r) {return in->p_out/in->vin_min + r->ripple_i_L/2.0;}
+static inline double boost_eq_ccm(const converter_input *in, const converter_result *r) {return in->p_out/in->vin_min > r->i_LB;}
+
+//Buck_Boost Converter, vin_min for worst case
+static inline double buck_boost_eq_d(const converter_input *in, const converter_result *r) {(void)r; return buck_boost_duty_d(in->vin_min, in->v_out);}
+static inline double buck_boost_eq_iout(const converter_input *in, const converter_result *r) {(void)r; return i_out_d(in->p_out, in->v_out);}
+static inline double buck_boost_eq_r(const converter_input *in, const converter_result *r) {(void)r; return r_load_d(in->v_out, in->p_out);}
+static inline double buck_boost_eq_dil(const converter_input *in, const converter_result *r) {return buck_boost_ripple_i_d(in->ripple_i_percent, r->i_out, 1.0 - r->duty_cycle);}
+static inline double buck_boost_eq_l(const converter_input *in, const converter_result *r) {return buck_boost_l_d(in->vin_min, r->duty_cycle, in->f_switch, r->ripple_i_L);}
+static inline double buck_boost_eq_dvc(const converter_input *in, const converter_result *r) {(void)r; return ripple_v_d(in->ripple_v_percent, in->v_out);}
+static inline double buck_boost_eq_c(const converter_input *in, const converter_result *r) {return buck_boost_c_d(r->i_out, r->duty_cycle, r->ripple_v_C, in->f_switch);}
+static inline double buck_boost_eq_ilb(const converter_input *in, const converter_result *r) {(void)in; return r->ripple_i_L/2.0;}
+static inline double buck_boost_eq_peak(const converter_input *in, const converter_result *r) {(void)in; return r->i_out / (1.0 - r->duty_cycle) + r->ripple_i_L / 2.0;}
+static inline double buck_boost_eq_ccm(const converter_input *in, const converter_result *r) {(void)in; return r->i_out / (1.0 - r->duty_cycle) > r->i_LB;}
+
+//CUK CONVERTER, vin_min for worst case
+static inline double cuk_eq_delta_il_1(const converter_input *in) {return cuk_delta_il_1_d(in->p_out, in->vin_min, in->ripple_i_1_percent);}
+static inline double cuk_eq_delta_il_2(const converter_input *in, const converter_result *r) {return cuk_delta_il_2_d(r->i_out, in->ripple_i_2_percent);}
+//worst delta IL and IL decide ccm or dcm
+static inline double cuk_eq_worst_delta_il(const converter_input *in, const converter_result *r) {
+    double delta_IL_1 = cuk_eq_delta_il_1(in);
+    double delta_IL_2 = cuk_eq_delta_il_2(in, r);
+    return delta_IL_1 > delta_IL_2 ? delta_IL_1 : delta_IL_2;
+}
+static inline double cuk_eq_worst_il(const converter_input *in, const converter_result *r) {
+    double i_in = in->p_out/in->vin_min;
+    return i_in > r->i_out ? i_in : r->i_out;
+}
+
+static inline double cuk_eq_d(const converter_input *in, const converter_result *r) {(void)r; return buck_boost_duty_d(in->vin_min, in->v_out);}
+static inline double cuk_eq_r(const converter_input *in, const converter_result *r) {(void)r; return r_load_d(in->v_out, in->p_out);}
+static inline double cuk_eq_iout(const converter_input *in, const converter_result *r) {(void)r; return i_out_d(in->p_out, in->v_out);}
+static inline double cuk_eq_l1(const converter_input *in, const converter_result *r) {
+    return cuk_l1_d(in->vin_min, r->duty_cycle, in->f_switch, cuk_eq_delta_il_1(in));
+}
+static inline double cuk_eq_l2(const converter_input *in, const converter_result *r) {
+    return cuk_l2_d(in->v_out, 1.0 - r->duty_cycle, in->f_switch, cuk_eq_delta_il_2(in, r));
+}
+static inline double cuk_eq_co(const converter_input *in, const converter_result *r) {
+    return cuk_co_d(in->v_out, 1.0 - r->duty_cycle, in->f_switch, in->ripple_v_percent, r->L2);
+}
+static inline double cuk_eq_cn(const converter_input *in, const converter_result *r) {
+    return cuk_cn_d(r->i_out, 1.0 - r->duty_cycle, in->f_switch, in->vin_min, in->ripple_v_cn_percent);
+}
+static inline double cuk_eq_ilb(const converter_input *in, const converter_result *r) {return cuk_eq_worst_delta_il(in, r)/2.0;}
+static inline double cuk_eq_peak(const converter_input *in, const converter_result *r) {return cuk_eq_worst_il(in, r) + r->i_LB;}
+static inline double cuk_eq_ccm(const converter_input *in, const converter_result *r) {return cuk_eq_worst_il(in, r) > r->i_LB;}
+
+#endif
@@ -6,31 +6,27 @@
 //Read input function
 static void read_input(converter_input *input);
 //Buck functions
-static int  buck_validate_input(const converter_input *input);
-static void buck_calculate(const converter_input *input, converter_result *result);
-static void buck_analyse(const converter_input *input, converter_result *result);
+static int  buck_validate_input(unsigned diag);
+static void buck_print_warnings(unsigned diag);
 static void buck_print_result(const converter_input *input, const converter_result *result);
 static void buck_save_file(const converter_input *input, const converter_result *result);
 
 //Boost functions
-static int  boost_validate_input(const converter_input *input);
-static void boost_calculate(const converter_input *input, converter_result *result);
-static void boost_analyse(const converter_input *input, converter_result *result);
+static int  boost_validate_input(unsigned diag);
+static void boost_print_warnings(unsigned diag);
 static void boost_print_result(const converter_input *input, const converter_result *result);
 static void boost_save_file(const converter_input *input, const converter_result *result);
 
 //Buck-Boost Converter
-static int  buck_boost_validate_input(const converter_input *input);
-static void buck_boost_analyse(const converter_input *input, converter_result *result);
-static void buck_boost_calculate(const converter_input *input, converter_result *result);
+static int  buck_boost_validate_input(unsigned diag);
+static void buck_boost_print_warnings(unsigned diag);
 static void buck_boost_print_result(const converter_input *input, const converter_result *result);
 static void buck_boost_save_file(const converter_input *input, const converter_result *result);
 
 //Cuk Converter
-static int  cuk_validate_input(const converter_input *input);
+static int  cuk_validate_input(unsigned diag);
 static void cuk_read_input(converter_input *input);
-static void cuk_calculate(const converter_input *input, converter_result *result);
-static void cuk_analyse(const converter_input *input, converter_result *result);
+static void cuk_print_warnings(unsigned diag);
 static void cuk_print_result(const converter_input *input, const converter_result *result);
 static void cuk_save_file(const converter_input *input, const converter_result *result);
 //read input
@@ -59,12 +55,13 @@ void buck_converter(void) {
     input.type = buck_conv;
     printf("\n>> Buck Converter\n");
     read_input(&input);
-    if (!buck_validate_input(&input)) {
+    unsigned diag;
+    design(&input, &result, 1, 0, &diag);
+    if (!buck_validate_input(diag)) {
         printf("\nInvalid input\n");
         return;
     }
-    buck_calculate(&input, &result);
-    buck_analyse(&input, &result);
+    buck_print_warnings(diag);
     buck_print_result(&input, &result);
 //ask if user want to save design
     char answer_for_saving;
@@ -74,82 +71,49 @@ void buck_converter(void) {
     }
 }
 
-static int buck_validate_input(const converter_input *input) {
-    int input_validate = 1;
+static int buck_validate_input(unsigned diag) {
+    if (diag & CONV_ERR_NONFINITE) {
+        printf("ERROR: Every value must be a finite number!\n");
+    }
     //Check if vin and vout are smaller than or equal to 0
-    if (input-> vin_min <= 0 || input-> vin_max <= 0 || input->v_out <= 0) {
+    if (diag & CONV_ERR_VOLTAGE) {
         printf("ERROR: Voltages must be > 0! \n");
-        input_validate = 0;
     }
     //Check if vin_min > vin_max
-    if (input-> vin_min > input-> vin_max) {
+    if (diag & CONV_ERR_VIN_RANGE) {
         printf("ERROR: minimum voltage must be smaller than maximum voltage!\n");
-        input_validate = 0;
     }
     //Check if vin_min < v_out. Buck is a stepdown converter
-    if (input-> v_out >= input->vin_min) {
+    if (diag & CONV_ERR_STEP) {
         printf("ERROR: Buck converter is step-down, require output voltage < minimum input voltage! \n");
-        input_validate = 0;
     }
     //Check if p_out < 0
-    if (input->p_out <= 0) {
+    if (diag & CONV_ERR_POWER) {
         printf("ERROR: Output power must be larger than 0! \n");
-        input_validate = 0;
     }
     //Check if switching frequency is smaller than 0
-    if (input-> f_switch <= 0) {
+    if (diag & CONV_ERR_FREQUENCY) {
         printf("ERROR: Switching frequency must be larger than 0! \n");
-        input_validate = 0;
     }
     //Check if current ripple is in range 0 - 100
-    if (input->ripple_i_percent <= 0 || input->ripple_i_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_I) {
         printf("ERROR: Inductor current ripple percentage must be > 0 and < 100. \n");
-        input_validate = 0;
     }
-    if (input->ripple_v_percent <= 0 || input->ripple_v_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_V) {
         printf("ERROR: Voltage ripple percentage must be > 0 and < 100. \n ");
-        input_validate = 0;
     }
-    return input_validate;
-}
-
-static void buck_calculate(const converter_input *input, converter_result *result) {
-    //use vin_min for worst case
-    double vin_worst = input->vin_min;
-    // K=Vout/Vin
-    result->duty_cycle = input->v_out / vin_worst;
-    //Rload from P-out
-    result->r_load = (input->v_out * input->v_out)/input->p_out;
-    //I out = Vout/Rload
-    result->i_out = input->v_out/result->r_load;
-    //From rippe percent to 0. Use 100.0 because use double
-    result->ripple_i_L = (input->ripple_i_percent / 100.0)*result->i_out;
-    //Inductor use vin max for worst case. Equation from 2501
-    double vin_L = input->vin_max;
-    result->L = (vin_L - input-> v_out)*result->duty_cycle/(input->f_switch*result->ripple_i_L);
-    //Capacitance. Equation from 2501
-    result->ripple_v_C = (input->ripple_v_percent/100.0)*input->v_out;
-    result->C = (result->ripple_i_L/(8.0*input->f_switch*result->ripple_v_C));
+    return !(diag & CONV_ERR_MASK);
 }
 
-static void buck_analyse(const converter_input * input, converter_result *result) {
-    //Check boundary condition dcm and ccm using i LB
-    result->i_LB = result-> ripple_i_L/2.0;
-    //Check ccm 1 or 0
-    if (result->i_out > result->i_LB) {
-    result->is_ccm = 1;
-    }
-    else {result->is_ccm = 0;}
-    //i_L peak
-    result->i_L_peak = result->i_out + result->ripple_i_L/2.0;
+static void buck_print_warnings(unsigned diag) {
     //Warning for DCM, high ripple current and volatge. Industry use.
-    if (!result->is_ccm) {
+    if (diag & CONV_WARN_DCM) {
         printf("WARNING: Converter is in DCM\n");
     }
-    if (result->ripple_i_L > 0.4*result->i_out) {
+    if (diag & CONV_WARN_RIPPLE_I) {
         printf("WARNING: Inductor ripple > 40%% of I out, consider using higher inductance inductor.\n");
     }
-    if (input->ripple_v_percent > 5.0) {
+    if (diag & CONV_WARN_RIPPLE_V) {
         printf("WARNING: Voltage ripple > 5%% of V out, consider using higher capacitance capacitor.\n");
     }
 }
@@ -204,12 +168,13 @@ void boost_converter(void) {
     input.type = boost_conv;
     printf("\n>> Boost Converter\n");
     read_input(&input);
-    if (!boost_validate_input(&input)) {
+    unsigned diag;
+    design(&input, &result, 1, 0, &diag);
+    if (!boost_validate_input(diag)) {
         printf("Invalid input\n");
         return;
     }
-    boost_calculate(&input, &result);
-    boost_analyse(&input, &result);
+    boost_print_warnings(diag);
     boost_print_result(&input, &result);
     //Ask if user want to save result
     char answer_for_saving;
@@ -219,71 +184,43 @@ void boost_converter(void) {
     }
 }
 
-static int boost_validate_input(const converter_input *input) {
-    int input_validate = 1;
-
-    if (input->vin_min <= 0 || input->vin_max <= 0 || input->v_out <= 0) {
+static int boost_validate_input(unsigned diag) {
+    if (diag & CONV_ERR_NONFINITE) {
+        printf("ERROR: Every value must be a finite number!\n");
+    }
+    if (diag & CONV_ERR_VOLTAGE) {
         printf("ERROR: Voltages must be > 0!\n");
-        input_validate = 0;
     }
-    
-    if (input->vin_min > input->vin_max) {
+    if (diag & CONV_ERR_VIN_RANGE) {
         printf("ERROR: Minimum input voltage must be <= maximum input voltage!\n");
-        input_validate = 0;
     }
     // Boost is step-up: Vout > Vin_max
-    if (input->v_out <= input->vin_max) {
+    if (diag & CONV_ERR_STEP) {
         printf("ERROR: Boost converter is step-up, require Vout > Vin_max!\n");
-        input_validate = 0;
     }
-    if (input->p_out <= 0) {
+    if (diag & CONV_ERR_POWER) {
         printf("ERROR: Output power must be larger than 0!\n");
-        input_validate = 0;
     }
-    if (input->f_switch <= 0) {
+    if (diag & CONV_ERR_FREQUENCY) {
         printf("ERROR: Switching frequency must be larger than 0!\n");
-        input_validate = 0;
     }
-    if (input->ripple_i_percent <= 0 || input->ripple_i_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_I) {
         printf("ERROR: Inductor current ripple percentage must be in > 0 and < 100.\n");
-        input_validate = 0;
     }
-    if (input->ripple_v_percent <= 0 || input->ripple_v_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_V) {
         printf("ERROR: Voltage ripple percentage must be > 0 and < 100.\n");
-        input_validate = 0;
     }
-
-    return input_validate;
-}
-
-static void boost_calculate(const converter_input *input, converter_result *result) {
-    //Equation from ELEC2501
-    //Vin min for wrost case
-    result->duty_cycle = 1.0 - input->vin_min/input->v_out;
-    result->r_load = (input->v_out*input->v_out)/input->p_out;
-    result->i_out = input->p_out/input->v_out;
-    double i_l_avg = input->p_out/input->vin_min;
-    result->ripple_i_L = input->ripple_i_percent*i_l_avg/100.0;
-    result->L = input->vin_min*result->duty_cycle/(result->ripple_i_L*input->f_switch);
-    result->ripple_v_C = (input->ripple_v_percent/100.0)*input->v_out;
-    result->C = (result->i_out*result->duty_cycle)/(input->f_switch*result->ripple_v_C);
+    return !(diag & CONV_ERR_MASK);
 }
 
-static void boost_analyse(const converter_input *input, converter_result *result) {
-    double i_L = input->p_out/input->vin_min;
-    result->i_LB =result->ripple_i_L/2.0;
-    if (i_L > result->i_LB) {
-        result->is_ccm = 1;
-    }
-    else {result->is_ccm = 0;}
-    result->i_L_peak = i_L + result->ripple_i_L/2.0;
-    if (!result->is_ccm) {
+static void boost_print_warnings(unsigned diag) {
+    if (diag & CONV_WARN_DCM) {
         printf("WARNING: Converter is in DCM at rated load (IL_avg <= IL/2).\n");
     }
-    if (input->ripple_i_percent > 40) {
+    if (diag & CONV_WARN_RIPPLE_I) {
         printf("WARNING: Inductor ripple in percent > 40%%, consider increasing L.\n");
     }
-    if (input->ripple_v_percent > 5.0) {
+    if (diag & CONV_WARN_RIPPLE_V) {
         printf("WARNING: Voltage ripple > 5%% of Vout, consider increasing C.\n");
     }
 }
@@ -346,12 +283,13 @@ void buck_boost_converter(void) {
     converter_result result = {0};
     read_input(&input);
     input.type = buck_boost_conv;
-    if (!buck_boost_validate_input(&input)) {
+    unsigned diag;
+    design(&input, &result, 1, 0, &diag);
+    if (!buck_boost_validate_input(diag)) {
         printf("\nInvalid input\n");
         return;
     }
-    buck_boost_calculate(&input, &result);
-    buck_boost_analyse(&input, &result);
+    buck_boost_print_warnings(diag);
     buck_boost_print_result(&input, &result);
     char answer_for_saving;
     printf("\nSave result to file? (y/n): ");
@@ -361,65 +299,40 @@ void buck_boost_converter(void) {
     /* you can call a function from here that handles menu 3 */
 }
 
-static int buck_boost_validate_input(const converter_input *input) {
-    int validate_input = 1;
+static int buck_boost_validate_input(unsigned diag) {
+    if (diag & CONV_ERR_NONFINITE) {
+        printf("ERROR: Every value must be a finite number!\n");
+    }
     //buck_boost converter can be step up or step down converter so no need to check relation between vin and vout
-    if (input->vin_min <= 0 || input->vin_max <= 0 || input->v_out <= 0) {
+    if (diag & CONV_ERR_VOLTAGE) {
         printf("ERROR: Voltages must be > 0!\n");
-        validate_input = 0;
     }
-    if (input->vin_min > input->vin_max) {
+    if (diag & CONV_ERR_VIN_RANGE) {
         printf("ERROR: Vin_min must be <= Vin_max!\n");
-        validate_input = 0;
     }
-    if (input->p_out <= 0) {
+    if (diag & CONV_ERR_POWER) {
         printf("ERROR: Output power must be > 0!\n");
-        validate_input = 0;
     }
-    if (input->f_switch <= 0) {
+    if (diag & CONV_ERR_FREQUENCY) {
         printf("ERROR: Switching frequency must be > 0!\n");
-        validate_input = 0;
     }
-    if (input->ripple_i_percent <= 0 || input->ripple_i_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_I) {
         printf("ERROR: Ripple current percent must be > 0 and < 100.\n");
-        validate_input = 0;
     }
-    if (input->ripple_v_percent <= 0 || input->ripple_v_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_V) {
         printf("ERROR: Ripple voltage percent must be > 0 and < 100.\n");
-        validate_input = 0;
     }
-    return validate_input;
+    return !(diag & CONV_ERR_MASK);
 }
 
-static void buck_boost_calculate(const converter_input *input, converter_result *result) {
-    //vin min for worst case
-    //Equation from 2501
-    result->duty_cycle = input->v_out/(input->vin_min+input->v_out);
-    result->i_out = input->p_out/input->v_out;
-    result->r_load = (input->v_out * input->v_out)/input->p_out;
-    double i_L = result->i_out/(1.0-result->duty_cycle);
-    result->ripple_i_L = (input->ripple_i_percent/100.0)*i_L;
-    result->L = input->vin_min*result->duty_cycle/(input->f_switch*result->ripple_i_L);
-    result->ripple_v_C = (input->ripple_v_percent/100.0)*input->v_out;
-    result->C = result->i_out*result->duty_cycle/(result->ripple_v_C*input->f_switch);
-}
-
-static void buck_boost_analyse(const converter_input *input, converter_result *result) {
-    double i_L = result->i_out / (1.0 - result->duty_cycle);
-    result->i_LB = result->ripple_i_L/2.0;
-    result->i_L_peak = i_L + result->ripple_i_L / 2.0;
-    if (i_L > result->i_LB) {
-        result->is_ccm = 1;
-    }
-    else {result->is_ccm = 0;}
-    
-    if (!result->is_ccm) {
+static void buck_boost_print_warnings(unsigned diag) {
+    if (diag & CONV_WARN_DCM) {
         printf("WARNING: Converter is in DCM at rated load.\n");
     }
-    if (input->ripple_i_percent > 40.0) {
+    if (diag & CONV_WARN_RIPPLE_I) {
         printf("WARNING: Inductor ripple > 40%% of IL, consider increasing L.\n");
     }
-    if (input->ripple_v_percent > 5.0) {
+    if (diag & CONV_WARN_RIPPLE_V) {
         printf("WARNING: Voltage ripple > 5%% of |Vout|, consider increasing C.\n");
     }
 }
@@ -480,12 +393,13 @@ void cuk_converter(void) {
     converter_result result = {0};
     cuk_read_input(&input);
     input.type = cuk_conv;
-    if (!cuk_validate_input(&input)) {
+    unsigned diag;
+    design(&input, &result, 1, 0, &diag);
+    if (!cuk_validate_input(diag)) {
         printf("\nInvalid input\n");
         return;
     }
-    cuk_calculate(&input, &result);
-    cuk_analyse(&input, &result);
+    cuk_print_warnings(diag);
     cuk_print_result(&input, &result);
     char answer_for_saving;
     printf("\nSave result to file? (y/n): ");
@@ -517,110 +431,63 @@ static void cuk_read_input(converter_input *input) {
     scanf("%lf", &input->ripple_v_cn_percent);
 }
 
-static void cuk_calculate(const converter_input *input, converter_result *result) {
-    //vin_min for wrost case
-    //equation from 2501
-    result->duty_cycle = input->v_out/(input->vin_min + input->v_out);
-    result->r_load = (input->v_out*input->v_out)/input->p_out;
-    result->i_out = input->p_out/input->v_out;
-    double i_in = input->p_out / input->vin_min;
-    double delta_IL_1 = i_in*input->ripple_i_1_percent/100.0;
-    double delta_IL_2 = result->i_out*input->ripple_i_2_percent/100.0;
-    double delta_v_out = input->v_out*input->ripple_v_percent/100.0;
-    double delta_v_cn = input->vin_min*input->ripple_v_cn_percent/100.0;
-    result->L1 = (input->vin_min*result->duty_cycle)/(input->f_switch*delta_IL_1);
-    result->L2 = (input->v_out*(1.0-result->duty_cycle))/(input->f_switch*delta_IL_2);
-    result->Co = input->v_out*(1.0-result->duty_cycle)/(8.0*input->f_switch*input->f_switch*delta_v_out*result->L2);
-    result->Cn = (result->i_out*(1.0-result->duty_cycle))/(input->f_switch*delta_v_cn);
-}
-
-static int cuk_validate_input(const converter_input *input) {
-    int input_validate = 1;
-
-    if (input->vin_min <= 0 || input->vin_max <= 0 || input->v_out <= 0) {
+static int cuk_validate_input(unsigned diag) {
+    if (diag & CONV_ERR_NONFINITE) {
+        printf("ERROR: Every value must be a finite number!\n");
+    }
+    if (diag & CONV_ERR_VOLTAGE) {
         printf("ERROR: Voltages must be > 0!\n");
-        input_validate = 0;
     }
 
-    if (input->vin_min > input->vin_max) {
+    if (diag & CONV_ERR_VIN_RANGE) {
         printf("ERROR: Minimum input voltage must be smaller than or equal to maximum input voltage!\n");
-        input_validate = 0;
     }
 
-    if (input->p_out <= 0) {
+    if (diag & CONV_ERR_POWER) {
         printf("ERROR: Output power must be larger than 0!\n");
-        input_validate = 0;
     }
 
-    if (input->f_switch <= 0) {
+    if (diag & CONV_ERR_FREQUENCY) {
         printf("ERROR: Switching frequency must be larger than 0!\n");
-        input_validate = 0;
     }
 
     //L1: 0–100%
-    if (input->ripple_i_1_percent <= 0 || input->ripple_i_1_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_I) {
         printf("ERROR: L1 current ripple percentage must be > 0 and < 100.\n");
-        input_validate = 0;
     }
 
     // L2: 0–100%
-    if (input->ripple_i_2_percent <= 0 || input->ripple_i_2_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_I_2) {
         printf("ERROR: L2 current ripple percentage must be > 0 and < 100.\n");
-        input_validate = 0;
     }
 
     //Co: 0–100%
-    if (input->ripple_v_percent <= 0 || input->ripple_v_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_V) {
         printf("ERROR: Output voltage ripple percentage must be > 0 and < 100.\n");
-        input_validate = 0;
     }
 
     // Cn: 0–100%
-    if (input->ripple_v_cn_percent <= 0 || input->ripple_v_cn_percent > 100) {
+    if (diag & CONV_ERR_RIPPLE_CN) {
         printf("ERROR: Cn voltage ripple percentage must be > 0 and < 100.\n");
-        input_validate = 0;
     }
 
-    return input_validate;
+    return !(diag & CONV_ERR_MASK);
 }
 
-static void cuk_analyse(const converter_input *input, converter_result *result) {
-    //calcaulate worst delta IL and IL to detect ccm or dcm
-    double i_in = input->p_out/input->vin_min;
-    double delta_IL_1 = i_in*input->ripple_i_1_percent/100.0;
-    double delta_IL_2 = result->i_out*input->ripple_i_2_percent/100.0;
-    double worst_delta_IL;
-    double worst_IL;
-    if (delta_IL_1 > delta_IL_2) {
-        worst_delta_IL = delta_IL_1;
-    }
-    else {worst_delta_IL = delta_IL_2;}
-
-    if (i_in>result->i_out) {
-        worst_IL = i_in;
-    }
-    else {worst_IL = result->i_out;}
-    result->i_LB = worst_delta_IL/2.0;
-    result->i_L_peak = worst_IL + worst_delta_IL/2.0;
-    //ccm or dcm
-    if (worst_IL > result->i_LB) {
-        result->is_ccm = 1;
-    }
-    else {result->is_ccm = 0;}
-
-    if (!result->is_ccm) {
+static void cuk_print_warnings(unsigned diag) {
+    if (diag & CONV_WARN_DCM) {
         printf("WARNING: Cuk converter may operate in DCM at rated load (IL <= IL/2).\n");
     }
 
-    if (input->ripple_i_1_percent > 40.0 || input->ripple_i_2_percent > 40.0) {
+    if (diag & CONV_WARN_RIPPLE_I) {
         printf("WARNING: Inductor current ripple > 40%% of average for at least one inductor; consider increasing L1 and/or L2.\n");
     }
 
-    if (input->ripple_v_percent > 5.0) {
+    if (diag & CONV_WARN_RIPPLE_V) {
         printf("WARNING: Output voltage ripple > 5%% of |Vout|; consider increasing Co.\n");
     }
 
-    if (input->ripple_v_cn_percent > 10.0) {
+    if (diag & CONV_WARN_RIPPLE_CN) {
         printf("WARNING: Cn voltage ripple > 10%% of Vin; consider increasing Cn.\n");
     }
 }
@@ -701,4 +568,60 @@ static void cuk_save_file(const converter_input *input, const converter_result *
     result->i_L_peak, result->i_LB, mode);
     fclose(fp);
     printf("Results saved to cuk_results.txt\n");
-}
\ No newline at end of file
+}
+
+//Shared design steps. The extra modes use these to get a finished design without the save prompt.
+int converter_read_design(converter_input *input, converter_result *result) {
+    int choice = 0;
+    printf("Select topology (1 = Buck, 2 = Boost, 3 = Buck-Boost, 4 = Cuk): ");
+    if (scanf("%d", &choice) != 1 || choice < 1 || choice > 4) {
+        printf("\nInvalid topology\n");
+        return 0;
+    }
+    input->type = (converter_type)(choice - 1);
+    converter_read_input(input);
+    if (!converter_design(input, result)) {
+        printf("\nInvalid input\n");
+        return 0;
+    }
+    return 1;
+}
+
+void converter_read_input(converter_input *input) {
+    if (input->type == cuk_conv) {cuk_read_input(input);}
+    else {read_input(input);}
+}
+
+//Validate, calculate and analyse by topology, printing errors and warnings. Return 0 if the input is invalid.
+int converter_design(const converter_input *input, converter_result *result) {
+    unsigned diag;
+    design(input, result, 1, 0, &diag);
+    switch (input->type) {
+        case buck_conv:
+            if (!buck_validate_input(diag)) return 0;
+            break;
+        case boost_conv:
+            if (!boost_validate_input(diag)) return 0;
+            break;
+        case buck_boost_conv:
+            if (!buck_boost_validate_input(diag)) return 0;
+            break;
+        case cuk_conv:
+            if (!cuk_validate_input(diag)) return 0;
+            break;
+        default:
+            return 0;
+    }
+    converter_print_warnings(input->type, diag);
+    return 1;
+}
+
+//Print the CONV_WARN_ bits of diag in the words of the topology
+void converter_print_warnings(converter_type type, unsigned diag) {
+    switch (type) {
+        case buck_conv:       buck_print_warnings(diag); break;
+        case boost_conv:      boost_print_warnings(diag); break;
+        case buck_boost_conv: buck_boost_print_warnings(diag); break;
+        case cuk_conv:        cuk_print_warnings(diag); break;
+    }
+}
@@ -0,0 +1,1254 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "converter.h"
+#include "precision.h"
+#include "tweak.h"
+#include "profile.h"
+#include "loss.h"
+//Differential fuzzer for the fast paths of the design equations.
+//The reference is design() on one converter at a time, that is *_validate, *_calculate and *_analyse
+//in converter.c. Every case is checked against it on
+//  batch    precision_float_batch() over the cases of a block, one SoA block per topology: within
+//           --tolerance % on the float32 domain
+//  tweak    tweak_recompute() after one parameter change: bit for bit, is_ccm included
+//  float    float32 calculators of precision.c: within --tolerance % on their domain
+//  fixed    Q16.16 calculators: within --fixed-tolerance % on their domain
+//  profile  profile_eval_chunk() at loads from 1 % to 6x rated against design() at each load: duty and
+//           peak within --tolerance %, the DCM and ripple flags the same away from their thresholds
+//The profile and loss checks run where inputs and results are within 1e-100..1e100.
+//  loss     the quadratic row fit of loss_efficiency_map() against one point maps over Vin and Pout:
+//           efficiency within --tolerance %, DCM flags the same
+//
+//Cases are random (spread over valid and edge-case ranges) or mutations of a corpus. converter.c,
+//tweak.c, precision.c, profile.c and loss.c are built with -fsanitize-coverage=trace-pc,trace-cmp, a case that reaches a
+//new basic block, a new comparison outcome or distance (e.g. i_out against i_LB at the CCM/DCM
+//boundary) or a new error size joins the corpus. A mismatch is shrunk to a reproducer file that
+//"fuzz.out --repro <file>" runs again.
+//
+//  fuzz.out [--seconds S] [--cases N] [--jobs J] [--seed X] [--checks batch,tweak,float,fixed,profile,loss]
+//           [--tolerance %] [--fixed-tolerance %] [--out dir]
+//  fuzz.out --repro <file>...
+
+#define FUZZ_BATCH        0x1u
+#define FUZZ_TWEAK        0x2u
+#define FUZZ_FLOAT        0x4u
+#define FUZZ_FIXED        0x8u
+#define FUZZ_PROFILE      0x10u
+#define FUZZ_LOSS         0x20u
+#define FUZZ_ALL          0x3fu
+#define FUZZ_CHECKS       6
+
+#define FUZZ_MAP          (1 << 16)   // feature bitmap
+#define FUZZ_MAX_HITS     4096        // features one case can report
+#define FUZZ_CORPUS       8192        // cases kept per thread
+#define FUZZ_BLOCK        64          // cases per design() batch
+#define FUZZ_MAX_REPROS   16          // reproducers written per run, later mismatches are only counted
+#define FUZZ_PARAMS       10          // TWEAK_ bits
+#define FUZZ_FIELDS       14          // compared converter_result fields
+
+//Domains of the reduced precision calculators. Outside them the audit in precision.c decides.
+#define FUZZ_FLOAT_LO     1e-6        // inputs (SI) and results (V, A, Ohm, H, F) of float32
+#define FUZZ_FLOAT_HI     1e6
+#define FUZZ_FLOAT_OUT_LO 1e-15
+#define FUZZ_FLOAT_OUT_HI 1e15
+#define FUZZ_DOUBLE_LO    1e-100      // inputs and results of the double fast paths, squares and loads stay normal
+#define FUZZ_DOUBLE_HI    1e100
+#define FUZZ_FIXED_LO     0.01        // every Q16.16 quantity in V, A, W, kHz, uH and uF
+#define FUZZ_FIXED_HI     16384.0
+#define FUZZ_COND         100.0       // most amplification of rounding by a difference (Vin_max - Vout ...)
+
+#define FUZZ_LOADS        8           // loads of the profile check
+#define FUZZ_FLAG_MARGIN  1e-9        // relative distance to a profile flag threshold where either outcome is right
+#define FUZZ_LOSS_VIN     3           // loss check grid, Vin_min..Vin_max
+#define FUZZ_LOSS_P       9           // and Pout/10..Pout
+
+typedef struct {
+    converter_input input;
+    unsigned param;     // TWEAK_ bit the tweak check changes, 0 for none
+    double value;       // its new value
+} fuzz_case;
+
+//A mismatch: the cases of a batch, the one that failed and the check it failed
+typedef struct {
+    fuzz_case block[FUZZ_BLOCK];
+    int n;
+    int index;
+    unsigned check;
+} fuzz_repro;
+
+typedef struct {
+    unsigned checks;
+    double tolerance;        // fraction, float32
+    double fixed_tolerance;  // fraction, Q16.16
+    const char *out_dir;
+} fuzz_options;
+
+typedef struct {
+    int job;
+    uint64_t seed;
+    const fuzz_options *opt;
+    fuzz_case *corpus;
+    int corpus_count;
+    long cases;
+    long comparisons;
+    long mismatch[FUZZ_CHECKS];
+} fuzz_job;
+
+static const char *const fuzz_check_names[FUZZ_CHECKS] = {"batch", "tweak", "float", "fixed", "profile", "loss"};
+static const char *const fuzz_param_names[FUZZ_PARAMS] = {
+    "vin_min", "vin_max", "v_out", "p_out", "f_switch",
+    "ripple_i", "ripple_i_1", "ripple_i_2", "ripple_v", "ripple_v_cn"
+};
+static const char *const fuzz_type_names[4] = {"buck", "boost", "buck_boost", "cuk"};
+
+static const struct {
+    const char *name;
+    size_t offset;
+    int is_int;
+} fuzz_fields[FUZZ_FIELDS] = {
+    {"duty_cycle", offsetof(converter_result, duty_cycle), 0},
+    {"r_load",     offsetof(converter_result, r_load), 0},
+    {"i_out",      offsetof(converter_result, i_out), 0},
+    {"ripple_i_L", offsetof(converter_result, ripple_i_L), 0},
+    {"ripple_v_C", offsetof(converter_result, ripple_v_C), 0},
+    {"L",          offsetof(converter_result, L), 0},
+    {"C",          offsetof(converter_result, C), 0},
+    {"L1",         offsetof(converter_result, L1), 0},
+    {"L2",         offsetof(converter_result, L2), 0},
+    {"Cn",         offsetof(converter_result, Cn), 0},
+    {"Co",         offsetof(converter_result, Co), 0},
+    {"i_L_peak",   offsetof(converter_result, i_L_peak), 0},
+    {"i_LB",       offsetof(converter_result, i_LB), 0},
+    {"is_ccm",     offsetof(converter_result, is_ccm), 1}
+};
+
+//Shared between the threads
+static uint8_t fuzz_global[FUZZ_MAP];
+static long fuzz_features;
+static int fuzz_stop;
+static int fuzz_repros;
+static pthread_mutex_t fuzz_report_lock = PTHREAD_MUTEX_INITIALIZER;
+
+//Features of the case being run, on the thread running it
+static __thread int fuzz_tracking;
+static __thread uint8_t fuzz_local[FUZZ_MAP];
+static __thread uint32_t fuzz_hit[FUZZ_MAX_HITS];
+static __thread int fuzz_hits;
+
+static void     *fuzz_worker(void *arg);
+static unsigned  fuzz_check_case(const fuzz_case *c, const fuzz_options *opt, int explain);
+static void      fuzz_check_batch(const fuzz_case *block, int n, const fuzz_options *opt, unsigned *failed,
+                                  int explain_index);
+static unsigned  fuzz_check_profile(const converter_input *rated, const converter_result *reference,
+                                    double tolerance, int explain);
+static unsigned  fuzz_check_loss(const converter_input *input, const converter_result *reference,
+                                 double tolerance, int explain);
+static int       fuzz_first_difference(const converter_result *a, const converter_result *b);
+static double    fuzz_max_error(const converter_input *input, const converter_result *result,
+                                const converter_result *reference, int *field);
+static int       fuzz_in_range(const converter_input *input, const converter_result *reference,
+                               double lo, double hi, double out_lo, double out_hi);
+static int       fuzz_float_domain(const converter_input *input, const converter_result *reference);
+static int       fuzz_fixed_domain(const converter_input *input, const converter_result *reference);
+static double    fuzz_condition(const converter_input *input);
+static void      fuzz_random_case(uint64_t *seed, fuzz_case *c);
+static void      fuzz_mutate(uint64_t *seed, fuzz_case *c);
+static void      fuzz_random_param(uint64_t *seed, fuzz_case *c);
+static int       fuzz_repro_fails(const fuzz_repro *r, const fuzz_options *opt);
+static void      fuzz_minimize(fuzz_repro *r, const fuzz_options *opt);
+static void      fuzz_report(fuzz_job *job, const fuzz_case *block, int n, int index, unsigned failed);
+static int       fuzz_write_repro(const fuzz_repro *r, const char *dir, char *path, size_t size);
+static int       fuzz_read_repro(const char *path, fuzz_repro *r);
+static int       fuzz_run_repro(const char *path, const fuzz_options *opt);
+static double   *fuzz_input_field(converter_input *input, int param);
+static unsigned  fuzz_parse_checks(const char *text);
+static double    fuzz_now(void);
+static void      fuzz_usage(void);
+
+int main(int argc, char **argv) {
+    fuzz_options opt = {FUZZ_ALL, 0.01/100.0, 1.0/100.0, "."};
+    double seconds = 10;
+    long max_cases = 0;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = (uint64_t)time(NULL);
+    int repro = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repro") == 0) {
+            repro = i + 1;
+            break;
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--cases") == 0 && i + 1 < argc) {
+            max_cases = strtol(argv[++i], NULL, 10);
+            seconds = 0;
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = (int)strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--checks") == 0 && i + 1 < argc) {
+            opt.checks = fuzz_parse_checks(argv[++i]);
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            opt.tolerance = strtod(argv[++i], NULL)/100.0;
+        } else if (strcmp(argv[i], "--fixed-tolerance") == 0 && i + 1 < argc) {
+            opt.fixed_tolerance = strtod(argv[++i], NULL)/100.0;
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            opt.out_dir = argv[++i];
+        } else {
+            fuzz_usage();
+            return 1;
+        }
+    }
+    if (repro) {
+        int failed = 0;
+        if (repro >= argc) {
+            fuzz_usage();
+            return 1;
+        }
+        for (int i = repro; i < argc; i++) {
+            failed |= fuzz_run_repro(argv[i], &opt);
+        }
+        return failed;
+    }
+    if (opt.checks == 0 || jobs < 1 || (seconds <= 0 && max_cases <= 0) ||
+        opt.tolerance <= 0 || opt.fixed_tolerance <= 0) {
+        fuzz_usage();
+        return 1;
+    }
+
+    fuzz_job *job = calloc((size_t)jobs, sizeof(*job));
+    pthread_t *thread = malloc((size_t)jobs*sizeof(*thread));
+    if (job == NULL || thread == NULL) {
+        printf("ERROR: out of memory\n");
+        return 1;
+    }
+    printf("Fuzzing with %d jobs, seed %llu, checks", jobs, (unsigned long long)seed);
+    for (int k = 0; k < FUZZ_CHECKS; k++) {
+        if (opt.checks & (1u << k)) {printf(" %s", fuzz_check_names[k]);}
+    }
+    printf("\n");
+
+    double start = fuzz_now();
+    for (int j = 0; j < jobs; j++) {
+        job[j].job = j;
+        job[j].seed = seed + 0x9e3779b97f4a7c15ULL*(uint64_t)(j + 1);
+        job[j].opt = &opt;
+        pthread_create(&thread[j], NULL, fuzz_worker, &job[j]);
+    }
+    //Progress every 10 s, then stop on time or once the threads have run the cases asked for
+    double report = start + 10;
+    for (;;) {
+        usleep(20000);
+        long cases = 0;
+        long comparisons = 0;
+        for (int j = 0; j < jobs; j++) {
+            cases += __atomic_load_n(&job[j].cases, __ATOMIC_RELAXED);
+            comparisons += __atomic_load_n(&job[j].comparisons, __ATOMIC_RELAXED);
+        }
+        double now = fuzz_now();
+        if ((seconds > 0 && now - start >= seconds) || (max_cases > 0 && cases >= max_cases)) {
+            break;
+        }
+        if (now >= report) {
+            printf("  %4.0f s: %ld cases, %.0f comparisons/s, %ld features\n", now - start, cases,
+                   comparisons/(now - start), __atomic_load_n(&fuzz_features, __ATOMIC_RELAXED));
+            fflush(stdout);
+            report += 10;
+        }
+    }
+    __atomic_store_n(&fuzz_stop, 1, __ATOMIC_RELAXED);
+    for (int j = 0; j < jobs; j++) {
+        pthread_join(thread[j], NULL);
+    }
+    double elapsed = fuzz_now() - start;
+
+    long cases = 0;
+    long comparisons = 0;
+    long corpus = 0;
+    long mismatch[FUZZ_CHECKS] = {0};
+    long mismatches = 0;
+    for (int j = 0; j < jobs; j++) {
+        cases += job[j].cases;
+        comparisons += job[j].comparisons;
+        corpus += job[j].corpus_count;
+        for (int k = 0; k < FUZZ_CHECKS; k++) {mismatch[k] += job[j].mismatch[k];}
+        free(job[j].corpus);
+    }
+    printf("%ld cases, %ld comparisons in %.1f s (%.0f comparisons/s, %.2e per hour)\n",
+           cases, comparisons, elapsed, comparisons/elapsed, comparisons/elapsed*3600.0);
+    printf("%ld features, %ld cases in the corpora\n", fuzz_features, corpus);
+    printf("Mismatches:");
+    for (int k = 0; k < FUZZ_CHECKS; k++) {
+        printf(" %s %ld", fuzz_check_names[k], mismatch[k]);
+        mismatches += mismatch[k];
+    }
+    printf("\n");
+    free(job);
+    free(thread);
+    return mismatches ? 1 : 0;
+}
+
+//Coverage hooks called by the instrumented code. Each one is a feature: a basic block, or a
+//comparison at one place with its outcome and how close the operands were.
+static void fuzz_feature(uint64_t key) {
+    if (!fuzz_tracking) {
+        return;
+    }
+    uint32_t h = (uint32_t)((key*0x9e3779b97f4a7c15ULL) >> 48) & (FUZZ_MAP - 1);
+    if (!fuzz_local[h]) {
+        fuzz_local[h] = 1;
+        if (fuzz_hits < FUZZ_MAX_HITS) {fuzz_hit[fuzz_hits++] = h;}
+    }
+}
+
+static uint64_t fuzz_caller(void *pc, uint64_t salt) {
+    return (uint64_t)(uintptr_t)pc ^ (salt << 48);
+}
+
+void __sanitizer_cov_trace_pc(void) {
+    fuzz_feature(fuzz_caller(__builtin_return_address(0), 0));
+}
+
+//Integers: which bits differ, as libFuzzer's value profile
+static void fuzz_cmp(void *pc, uint64_t a, uint64_t b) {
+    fuzz_feature(fuzz_caller(pc, 1 + (uint64_t)__builtin_popcountll(a ^ b)));
+}
+
+void __sanitizer_cov_trace_cmp1(uint8_t a, uint8_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_cmp2(uint16_t a, uint16_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_cmp4(uint32_t a, uint32_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_cmp8(uint64_t a, uint64_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_const_cmp1(uint8_t a, uint8_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_const_cmp2(uint16_t a, uint16_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_const_cmp4(uint32_t a, uint32_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_const_cmp8(uint64_t a, uint64_t b) {fuzz_cmp(__builtin_return_address(0), a, b);}
+
+//Doubles: outcome, and the relative distance in powers of two, so cases that bring i_out and i_LB
+//(or Vout and Vin_min) closer together are new features until they meet
+static void fuzz_cmp_double(void *pc, double a, double b) {
+    uint64_t outcome = a < b ? 1 : a > b ? 2 : a == b ? 3 : 4;
+    uint64_t distance = 0;
+    if (outcome < 3 && isfinite(a) && isfinite(b)) {
+        double scale = fmax(fabs(a), fabs(b));
+        int e = ilogb(fabs(a - b)/scale);
+        distance = (uint64_t)(e < -63 ? 64 : -e) + 1;
+    }
+    fuzz_feature(fuzz_caller(pc, 100 + outcome*128 + distance));
+}
+
+void __sanitizer_cov_trace_cmpf(float a, float b) {fuzz_cmp_double(__builtin_return_address(0), a, b);}
+void __sanitizer_cov_trace_cmpd(double a, double b) {fuzz_cmp_double(__builtin_return_address(0), a, b);}
+
+//cases is {count, bit width, case values...}, only the value switched on is used
+void __sanitizer_cov_trace_switch(uint64_t value, void *cases) {
+    (void)cases;
+    fuzz_feature(fuzz_caller(__builtin_return_address(0), 1000 + (value & 0xff)));
+}
+
+//Start tracking one case
+static void fuzz_begin(void) {
+    fuzz_hits = 0;
+    fuzz_tracking = 1;
+}
+
+//Stop tracking, return how many of its features no thread had seen before
+static int fuzz_end(void) {
+    int fresh = 0;
+    fuzz_tracking = 0;
+    for (int i = 0; i < fuzz_hits; i++) {
+        uint32_t h = fuzz_hit[i];
+        fuzz_local[h] = 0;
+        if (!__atomic_load_n(&fuzz_global[h], __ATOMIC_RELAXED) &&
+            !__atomic_exchange_n(&fuzz_global[h], 1, __ATOMIC_RELAXED)) {
+            fresh++;
+        }
+    }
+    if (fresh) {
+        __atomic_add_fetch(&fuzz_features, fresh, __ATOMIC_RELAXED);
+    }
+    return fresh;
+}
+
+static uint64_t fuzz_next(uint64_t *seed) {
+    uint64_t x = *seed ? *seed : 0x9e3779b97f4a7c15ULL;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *seed = x;
+    return x*0x2545f4914f6cdd1dULL;
+}
+
+static double fuzz_uniform(uint64_t *seed) {
+    return (fuzz_next(seed) >> 11)*(1.0/9007199254740992.0);
+}
+
+static int fuzz_below(uint64_t *seed, int n) {
+    return (int)((fuzz_next(seed) >> 33) % (uint64_t)n);
+}
+
+//10^a .. 10^b, log-uniform
+static double fuzz_decades(uint64_t *seed, double a, double b) {
+    return pow(10.0, a + (b - a)*fuzz_uniform(seed));
+}
+
+//Nominal designs the corpora start from
+static const fuzz_case fuzz_seeds[4] = {
+    {{buck_conv, 40, 60, 12, 100, 100000, 20, 0, 0, 1, 0}, TWEAK_F_SWITCH, 200000},
+    {{boost_conv, 12, 24, 48, 200, 100000, 30, 0, 0, 1, 0}, TWEAK_V_OUT, 60},
+    {{buck_boost_conv, 18, 36, 24, 150, 200000, 25, 0, 0, 0.5, 0}, TWEAK_RIPPLE_I, 40},
+    {{cuk_conv, 40, 60, 12, 100, 100000, 0, 20, 20, 1, 5}, TWEAK_RIPPLE_V_CN, 10}
+};
+
+static void *fuzz_worker(void *arg) {
+    fuzz_job *job = arg;
+    const fuzz_options *opt = job->opt;
+    fuzz_case block[FUZZ_BLOCK];
+    unsigned failed[FUZZ_BLOCK];
+    int checks = __builtin_popcount(opt->checks);
+
+    job->corpus = malloc(FUZZ_CORPUS*sizeof(fuzz_case));
+    if (job->corpus == NULL) {
+        return NULL;
+    }
+    memcpy(job->corpus, fuzz_seeds, sizeof(fuzz_seeds));
+    job->corpus_count = 4;
+
+    while (!__atomic_load_n(&fuzz_stop, __ATOMIC_RELAXED)) {
+        for (int i = 0; i < FUZZ_BLOCK; i++) {
+            //One case in four is new, the rest are mutations of the corpus
+            if (fuzz_below(&job->seed, 4) == 0) {
+                fuzz_random_case(&job->seed, &block[i]);
+            } else {
+                block[i] = job->corpus[fuzz_below(&job->seed, job->corpus_count)];
+                fuzz_mutate(&job->seed, &block[i]);
+            }
+            fuzz_begin();
+            failed[i] = fuzz_check_case(&block[i], opt, 0);
+            if (fuzz_end() > 0) {
+                int slot = job->corpus_count < FUZZ_CORPUS ? job->corpus_count++
+                                                           : fuzz_below(&job->seed, FUZZ_CORPUS);
+                job->corpus[slot] = block[i];
+            }
+        }
+        if (opt->checks & FUZZ_BATCH) {
+            fuzz_check_batch(block, FUZZ_BLOCK, opt, failed, -1);
+        }
+        for (int i = 0; i < FUZZ_BLOCK; i++) {
+            if (failed[i]) {
+                fuzz_report(job, block, FUZZ_BLOCK, i, failed[i]);
+            }
+        }
+        __atomic_store_n(&job->cases, job->cases + FUZZ_BLOCK, __ATOMIC_RELAXED);
+        __atomic_store_n(&job->comparisons, job->comparisons + (long)FUZZ_BLOCK*checks, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+//Run every check but batch on one case. Return the bits of the checks that failed.
+//explain prints what differs.
+static unsigned fuzz_check_case(const fuzz_case *c, const fuzz_options *opt, int explain) {
+    converter_result reference;
+    converter_result result;
+    unsigned diag;
+    unsigned failed = 0;
+
+    memset(&reference, 0, sizeof(reference));
+    design(&c->input, &reference, 1, 0, &diag);
+    fuzz_feature(((uint64_t)c->input.type << 32) | diag | (1ULL << 40));
+    if (diag & CONV_ERR_MASK) {
+        return 0;
+    }
+
+    if ((opt->checks & FUZZ_TWEAK) && c->param) {
+        converter_input changed = c->input;
+        converter_result full;
+        unsigned changed_diag;
+        *fuzz_input_field(&changed, __builtin_ctz(c->param)) = c->value;
+        memset(&full, 0, sizeof(full));
+        design(&changed, &full, 1, 0, &changed_diag);
+        //tweak rejects a change that makes the design invalid
+        if (!(changed_diag & CONV_ERR_MASK)) {
+            unsigned nodes;
+            result = reference;
+            tweak_recompute(&changed, &result, c->param, &nodes);
+            fuzz_feature(((uint64_t)c->input.type << 40) | ((uint64_t)c->param << 20) | nodes | (2ULL << 48));
+            int field = fuzz_first_difference(&result, &full);
+            if (field >= 0) {
+                failed |= FUZZ_TWEAK;
+                if (explain) {
+                    printf("  tweak %s=%.17g: %s is %.17g, a full design gives %.17g\n",
+                           fuzz_param_names[__builtin_ctz(c->param)], c->value, fuzz_fields[field].name,
+                           fuzz_fields[field].is_int ? *(int *)((char *)&result + fuzz_fields[field].offset)
+                                                     : *(double *)((char *)&result + fuzz_fields[field].offset),
+                           fuzz_fields[field].is_int ? *(int *)((char *)&full + fuzz_fields[field].offset)
+                                                     : *(double *)((char *)&full + fuzz_fields[field].offset));
+                }
+            }
+        }
+    }
+
+    for (int k = 0; k < 2; k++) {
+        unsigned check = k == 0 ? FUZZ_FLOAT : FUZZ_FIXED;
+        double tolerance = k == 0 ? opt->tolerance : opt->fixed_tolerance;
+        if (!(opt->checks & check)) {
+            continue;
+        }
+        int in_domain = k == 0 ? fuzz_float_domain(&c->input, &reference)
+                               : fuzz_fixed_domain(&c->input, &reference);
+        if (!in_domain) {
+            continue;
+        }
+        int field;
+        memset(&result, 0, sizeof(result));
+        precision_calculate(k == 0 ? prec_float : prec_fixed, &c->input, &result, 1);
+        double error = fuzz_max_error(&c->input, &result, &reference, &field);
+        //Error size in decades is a feature, so cases that make the kernels worse are kept
+        int decades = error > 0 ? (int)fmin(20.0, -log10(error)) : 21;
+        fuzz_feature(((uint64_t)c->input.type << 8) | ((uint64_t)decades << 16) | (3ULL + k) << 48);
+        if (error > tolerance) {
+            failed |= check;
+            if (explain) {
+                double got = *(double *)((char *)&result + fuzz_fields[field].offset);
+                double want = *(double *)((char *)&reference + fuzz_fields[field].offset);
+                printf("  %s: %s is %.9g, the reference gives %.17g (%.3g %% off)\n", fuzz_check_names[2 + k],
+                       fuzz_fields[field].name, got, want, error*100.0);
+            }
+        }
+    }
+
+    //the double fast paths away from underflow and overflow
+    if ((opt->checks & (FUZZ_PROFILE | FUZZ_LOSS))
+        && fuzz_in_range(&c->input, &reference, FUZZ_DOUBLE_LO, FUZZ_DOUBLE_HI, FUZZ_DOUBLE_LO, FUZZ_DOUBLE_HI)) {
+        if (opt->checks & FUZZ_PROFILE) {
+            failed |= fuzz_check_profile(&c->input, &reference, opt->tolerance, explain);
+        }
+        if (opt->checks & FUZZ_LOSS) {
+            failed |= fuzz_check_loss(&c->input, &reference, opt->tolerance, explain);
+        }
+    }
+    return failed;
+}
+
+//precision_float_batch() over the cases of the block in the float32 domain, one SoA block per topology,
+//against design() of each case alone. Sets FUZZ_BATCH in failed[i].
+static void fuzz_check_batch(const fuzz_case *block, int n, const fuzz_options *opt, unsigned *failed,
+                             int explain_index) {
+    precision_float_block soa;
+    converter_result reference[FUZZ_BLOCK];
+    int lane_case[FUZZ_BLOCK];
+
+    for (int t = 0; t < 4; t++) {
+        soa.type = (converter_type)t;
+        soa.n = 0;
+        for (int i = 0; i < n; i++) {
+            const converter_input *in = &block[i].input;
+            unsigned diag;
+            if (in->type != (converter_type)t) {
+                continue;
+            }
+            memset(&reference[i], 0, sizeof(reference[i]));
+            design(in, &reference[i], 1, 0, &diag);
+            if ((diag & CONV_ERR_MASK) || !fuzz_float_domain(in, &reference[i])) {
+                continue;
+            }
+            int lane = soa.n++;
+            lane_case[lane] = i;
+            soa.vin_min[lane] = (float)in->vin_min;
+            soa.vin_max[lane] = (float)in->vin_max;
+            soa.v_out[lane] = (float)in->v_out;
+            soa.p_out[lane] = (float)in->p_out;
+            soa.f_switch[lane] = (float)in->f_switch;
+            soa.ripple_i[lane] = (float)(t == cuk_conv ? in->ripple_i_1_percent : in->ripple_i_percent);
+            soa.ripple_i_2[lane] = (float)in->ripple_i_2_percent;
+            soa.ripple_v[lane] = (float)in->ripple_v_percent;
+            soa.ripple_v_cn[lane] = (float)in->ripple_v_cn_percent;
+        }
+        if (soa.n == 0) {
+            continue;
+        }
+        precision_float_batch(&soa);
+        for (int lane = 0; lane < soa.n; lane++) {
+            int i = lane_case[lane];
+            converter_result result;
+            int field;
+            memset(&result, 0, sizeof(result));
+            result.duty_cycle = soa.duty[lane];
+            result.r_load = soa.r_load[lane];
+            result.i_out = soa.i_out[lane];
+            if (t == cuk_conv) {
+                result.L1 = soa.L[lane];
+                result.L2 = soa.L2[lane];
+                result.Co = soa.C[lane];
+                result.Cn = soa.Cn[lane];
+            } else {
+                result.L = soa.L[lane];
+                result.C = soa.C[lane];
+            }
+            double error = fuzz_max_error(&block[i].input, &result, &reference[i], &field);
+            if (error > opt->tolerance) {
+                failed[i] |= FUZZ_BATCH;
+                if (i == explain_index) {
+                    double got = *(double *)((char *)&result + fuzz_fields[field].offset);
+                    double want = *(double *)((char *)&reference[i] + fuzz_fields[field].offset);
+                    printf("  batch, lane %d of %d: %s is %.9g, the reference gives %.17g (%.3g %% off)\n",
+                           lane, soa.n, fuzz_fields[field].name, got, want, error*100.0);
+                }
+            }
+        }
+    }
+}
+
+static int fuzz_close(double value, double reference, double tolerance) {
+    return fabs(value - reference) <= tolerance*fabs(reference);
+}
+
+//Within FUZZ_FLAG_MARGIN of a threshold the model and design() round to either side
+static int fuzz_near(double value, double threshold) {
+    return fabs(value - threshold) <= FUZZ_FLAG_MARGIN*fabs(threshold);
+}
+
+//profile_eval_chunk() against design() of the same converter at each load, as in test_profile.
+//In DCM the reference duty and peak come from IL/ILB = (D/D_ccm)^2, cuk keeps its CCM values.
+static unsigned fuzz_check_profile(const converter_input *rated, const converter_result *reference,
+                                   double tolerance, int explain) {
+    static const double loads[FUZZ_LOADS] = {6.0, 1.0, 0.5, 0.2, 0.1, 0.05, 0.02, 0.01};
+    profile_model model;
+    double p_out[FUZZ_LOADS];
+    double duty[FUZZ_LOADS];
+    double i_peak[FUZZ_LOADS];
+    unsigned char flags[FUZZ_LOADS];
+
+    profile_build_model(rated, reference, &model);
+    for (int k = 0; k < FUZZ_LOADS; k++) {
+        p_out[k] = rated->p_out*loads[k];
+    }
+    profile_eval_chunk(&model, p_out, FUZZ_LOADS, duty, i_peak, flags);
+    for (int k = 0; k < FUZZ_LOADS; k++) {
+        converter_input input;
+        converter_result result;
+        unsigned diag;
+        memset(&result, 0, sizeof(result));
+        profile_input_at(rated, p_out[k], &input);
+        design(&input, &result, 1, CONV_NO_VALIDATE, &diag);
+        double want_duty = result.duty_cycle;
+        double want_peak = result.i_L_peak;
+        if (!result.is_ccm && rated->type != cuk_conv) {
+            double root = sqrt((result.i_L_peak - result.i_LB)/result.i_LB);
+            want_duty = result.duty_cycle*root;
+            want_peak = 2.0*result.i_LB*root;
+        }
+        //a load whose design overflows has nothing to compare with
+        if (!isfinite(p_out[k]) || !isfinite(want_duty) || !isfinite(want_peak)) {
+            continue;
+        }
+        unsigned want = (!result.is_ccm ? profile_flag_dcm : 0u)
+                      | (diag & CONV_WARN_RIPPLE_I ? profile_flag_ripple_i : 0u)
+                      | (diag & CONV_WARN_RIPPLE_V ? profile_flag_ripple_v : 0u);
+        double ripple_v = model.ripple_v_const + model.ripple_v_per_watt*p_out[k];
+        unsigned either = (fuzz_near(model.amps_per_watt*p_out[k], model.i_LB) ? profile_flag_dcm : 0u)
+                        | (fuzz_near(model.ripple_i_watts, 40.0*p_out[k]) ? profile_flag_ripple_i : 0u)
+                        | (fuzz_near(ripple_v, 5.0) ? profile_flag_ripple_v : 0u);
+        const char *what = NULL;
+        double got = 0;
+        double expected = 0;
+        if (!fuzz_close(duty[k], want_duty, tolerance)) {
+            what = "duty";
+            got = duty[k];
+            expected = want_duty;
+        } else if (!fuzz_close(i_peak[k], want_peak, tolerance)) {
+            what = "i_L_peak";
+            got = i_peak[k];
+            expected = want_peak;
+        } else if ((flags[k] ^ want) & ~either) {
+            what = "flags";
+            got = flags[k];
+            expected = want;
+        }
+        if (what) {
+            if (explain) {
+                printf("  profile at %.17g W (%g x rated): %s is %.17g, design() gives %.17g\n",
+                       p_out[k], loads[k], what, got, expected);
+            }
+            return FUZZ_PROFILE;
+        }
+    }
+    return 0;
+}
+
+//loss_efficiency_map() fits each Vin row from three points, a map of one point evaluates the
+//loss equations directly. Typical device parameters, the fit is exact for any.
+static unsigned fuzz_check_loss(const converter_input *input, const converter_result *reference,
+                                double tolerance, int explain) {
+    static const loss_params params = {0.05, 20e-9, 20e-9, 0.5, 0.02, 0.01};
+    loss_design loss;
+    loss_grid grid = {input->vin_min, input->vin_max, FUZZ_LOSS_VIN, input->p_out/10.0, input->p_out, FUZZ_LOSS_P};
+    double eff[FUZZ_LOSS_VIN*FUZZ_LOSS_P];
+    unsigned char dcm[FUZZ_LOSS_VIN*FUZZ_LOSS_P];
+
+    loss_build_design(input, reference, &params, &loss);
+    if (!loss_efficiency_map(&loss, &grid, eff, dcm, 1)) {
+        return 0;
+    }
+    //the points the same way loss_tile places them
+    double vin_step = (grid.vin_hi - grid.vin_lo)/(grid.vin_points - 1);
+    double p_step = (grid.p_hi - grid.p_lo)/(grid.p_points - 1);
+    for (int row = 0; row < FUZZ_LOSS_VIN; row++) {
+        for (int col = 0; col < FUZZ_LOSS_P; col++) {
+            double vin = grid.vin_lo + row*vin_step;
+            double p = grid.p_lo + col*p_step;
+            loss_grid point = {vin, vin, 1, p, p, 1};
+            double exact;
+            unsigned char exact_dcm;
+            int i = row*FUZZ_LOSS_P + col;
+            loss_efficiency_map(&loss, &point, &exact, &exact_dcm, 1);
+            if (!fuzz_close(eff[i], exact, tolerance) || dcm[i] != exact_dcm) {
+                if (explain) {
+                    printf("  loss at Vin %.17g V, Pout %.17g W: efficiency %.17g%s, the direct equations give %.17g%s\n",
+                           vin, p, eff[i], dcm[i] ? " (DCM)" : "", exact, exact_dcm ? " (DCM)" : "");
+                }
+                return FUZZ_LOSS;
+            }
+        }
+    }
+    return 0;
+}
+
+//Index of the first field that is not bit for bit the same, -1 if none. Any NaN matches any other:
+//CONV_NO_VALIDATE runs and valid inputs that overflow still make NaN, and its sign depends on the
+//order of operations.
+static int fuzz_first_difference(const converter_result *a, const converter_result *b) {
+    for (int i = 0; i < FUZZ_FIELDS; i++) {
+        const char *x = (const char *)a + fuzz_fields[i].offset;
+        const char *y = (const char *)b + fuzz_fields[i].offset;
+        if (fuzz_fields[i].is_int) {
+            if (memcmp(x, y, sizeof(int)) != 0) {return i;}
+        } else if (memcmp(x, y, sizeof(double)) != 0 && !(isnan(*(const double *)x) && isnan(*(const double *)y))) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+//Largest relative error over the fields the reduced precision calculators produce
+static double fuzz_max_error(const converter_input *input, const converter_result *result,
+                             const converter_result *reference, int *field) {
+    static const int plain[] = {0, 1, 2, 5, 6};      // D, R_load, Iout, L, C
+    static const int cuk[] = {0, 1, 2, 7, 8, 9, 10}; // D, R_load, Iout, L1, L2, Cn, Co
+    const int *list = input->type == cuk_conv ? cuk : plain;
+    int count = input->type == cuk_conv ? 7 : 5;
+    double worst = 0;
+
+    *field = list[0];
+    for (int i = 0; i < count; i++) {
+        double got = *(const double *)((const char *)result + fuzz_fields[list[i]].offset);
+        double want = *(const double *)((const char *)reference + fuzz_fields[list[i]].offset);
+        double error = fabs(got - want)/fabs(want);
+        if (!(error <= worst)) {
+            worst = isnan(error) ? INFINITY : error;
+            *field = list[i];
+        }
+    }
+    return worst;
+}
+
+//Rounding in a difference of two close values (Vin_max - Vout for buck, 1 - Vin/Vout for boost)
+//is amplified by this much. The reduced precision calculators are only held to tolerance below FUZZ_COND.
+static double fuzz_condition(const converter_input *input) {
+    switch (input->type) {
+        case buck_conv:  return input->vin_max/(input->vin_max - input->v_out);
+        case boost_conv: return input->v_out/(input->v_out - input->vin_min);
+        default:         return 1.0;
+    }
+}
+
+static int fuzz_in(double x, double lo, double hi) {
+    return x >= lo && x <= hi;
+}
+
+//Every input the topology takes in lo..hi and every result that is not 0 in out_lo..out_hi
+static int fuzz_in_range(const converter_input *input, const converter_result *reference,
+                         double lo, double hi, double out_lo, double out_hi) {
+    const tweak_graph *graph = tweak_graph_for(input->type);
+    for (int i = 0; i < FUZZ_PARAMS; i++) {
+        double value = *fuzz_input_field((converter_input *)input, i);
+        if ((graph->inputs & (1u << i)) && !fuzz_in(value, lo, hi)) {return 0;}
+    }
+    const double *out = &reference->duty_cycle;
+    for (int i = 0; i < 11; i++) {
+        if (out[i] != 0 && !fuzz_in(fabs(out[i]), out_lo, out_hi)) {return 0;}
+    }
+    return 1;
+}
+
+static int fuzz_float_domain(const converter_input *input, const converter_result *reference) {
+    return fuzz_in_range(input, reference, FUZZ_FLOAT_LO, FUZZ_FLOAT_HI, FUZZ_FLOAT_OUT_LO, FUZZ_FLOAT_OUT_HI)
+        && fuzz_condition(input) <= FUZZ_COND;
+}
+
+//Q16.16 works in V, A, W, kHz, uH and uF with 1/65536 resolution, so every quantity and every
+//intermediate of fixed_calculate has to be well above the resolution and below 32767
+static int fuzz_fixed_domain(const converter_input *input, const converter_result *reference) {
+    double vin = input->vin_min;
+    double v_out = input->v_out;
+    double f_khz = input->f_switch/1000.0;
+    double ripple_v = input->ripple_v_percent/100.0*v_out;
+    double q[32];             // 28 for cuk
+    int n = 0;
+
+    q[n++] = vin;
+    q[n++] = input->vin_max;
+    q[n++] = v_out;
+    q[n++] = input->p_out;
+    q[n++] = f_khz;
+    q[n++] = ripple_v;
+    q[n++] = reference->r_load;
+    q[n++] = reference->i_out;
+    q[n++] = reference->duty_cycle;
+    q[n++] = input->p_out/vin;
+    q[n++] = input->ripple_v_percent/100.0;
+    if (input->type == cuk_conv) {
+        double one_minus_d = vin/(vin + v_out);
+        double delta_IL_2 = input->ripple_i_2_percent/100.0*reference->i_out;
+        double co = v_out*one_minus_d/ripple_v;
+        q[n++] = one_minus_d;
+        q[n++] = input->ripple_i_1_percent/100.0;
+        q[n++] = input->ripple_i_2_percent/100.0;
+        q[n++] = input->ripple_v_cn_percent/100.0;
+        q[n++] = input->ripple_i_1_percent/100.0*input->p_out/vin;
+        q[n++] = delta_IL_2;
+        q[n++] = input->ripple_v_cn_percent/100.0*vin;
+        q[n++] = v_out*one_minus_d/delta_IL_2;
+        q[n++] = reference->L1*1e6*f_khz/1000.0;    // before the divide by f
+        q[n++] = reference->Cn*1e6*f_khz/1000.0;
+        q[n++] = co;
+        q[n++] = co*1000.0/f_khz;
+        q[n++] = co*1e6/(f_khz*f_khz);
+        q[n++] = reference->L1*1e6;
+        q[n++] = reference->L2*1e6;
+        q[n++] = reference->Co*1e6;
+        q[n++] = reference->Cn*1e6;
+    } else {
+        double one_minus_d = input->type == buck_boost_conv ? vin/(vin + v_out) : 1.0 - reference->duty_cycle;
+        q[n++] = one_minus_d;
+        q[n++] = input->ripple_i_percent/100.0;
+        if (input->type == buck_conv) {q[n++] = input->vin_max - v_out;}   // buck L starts from it
+        if (input->type == boost_conv) {q[n++] = v_out - vin;}             // boost D is 1 - Vin/Vout
+        q[n++] = reference->ripple_i_L;
+        q[n++] = reference->L*1e6*f_khz/1000.0;     // before the divide by f
+        q[n++] = reference->C*1e6*f_khz/1000.0;
+        q[n++] = reference->L*1e6;
+        q[n++] = reference->C*1e6;
+    }
+    assert(n <= (int)(sizeof(q)/sizeof(q[0])));
+    for (int i = 0; i < n; i++) {
+        if (!fuzz_in(q[i], FUZZ_FIXED_LO, FUZZ_FIXED_HI)) {return 0;}
+    }
+    return fuzz_condition(input) <= FUZZ_COND;
+}
+
+//A value for one field: typical, near a validation limit, extreme or garbage
+static double fuzz_random_value(uint64_t *seed, int param, const converter_input *input) {
+    int ripple = param >= 5;
+    switch (fuzz_below(seed, 16)) {
+        case 0:  return ripple ? 100.0 : fuzz_decades(seed, -300, 300);
+        case 1:  return ripple ? nextafter(100.0, INFINITY) : DBL_MIN*fuzz_uniform(seed);
+        case 2:  return ripple ? fuzz_decades(seed, -15, -1) : DBL_MAX*fuzz_uniform(seed);
+        case 3:  return ripple ? 100.0 - fuzz_decades(seed, -13, 0) : 0.0;
+        case 4:  return ripple ? 100.0 + 300.0*fuzz_uniform(seed) : -fuzz_decades(seed, -3, 4);
+        case 5:  return ripple ? 200.0 : input->vin_min*(1.0 + (fuzz_uniform(seed) - 0.5)*1e-12);
+        case 6: {
+            union {uint64_t u; double d;} bits = {fuzz_next(seed)};
+            return bits.d;          // any bit pattern, NaN and infinities included
+        }
+        default:
+            if (ripple) {return 100.0*fuzz_uniform(seed);}
+            if (param == 4) {return fuzz_decades(seed, 0, 12);}
+            if (param == 3) {return fuzz_decades(seed, -3, 6);}
+            return fuzz_decades(seed, -3, 4);
+    }
+}
+
+//Random case, mostly valid, with Vout close to its limit and ripples near 0 or 100 % often
+static void fuzz_random_case(uint64_t *seed, fuzz_case *c) {
+    converter_input *in = &c->input;
+
+    memset(c, 0, sizeof(*c));
+    in->type = (converter_type)fuzz_below(seed, 4);
+    in->vin_min = fuzz_decades(seed, -3, 4);
+    in->vin_max = in->vin_min*(fuzz_below(seed, 4) == 0 ? 1.0 : 1.0 + fuzz_decades(seed, -12, 1));
+    double near = fuzz_below(seed, 2) ? fuzz_decades(seed, -16, -1) : fuzz_uniform(seed);
+    switch (in->type) {
+        case buck_conv:  in->v_out = in->vin_min*(1.0 - near); break;
+        case boost_conv: in->v_out = in->vin_max*(1.0 + near*10.0); break;
+        default:         in->v_out = fuzz_decades(seed, -3, 4); break;
+    }
+    in->p_out = fuzz_decades(seed, -3, 6);
+    in->f_switch = fuzz_decades(seed, 0, 12);
+    double *ripple = &in->ripple_i_percent;
+    for (int i = 0; i < 5; i++) {
+        switch (fuzz_below(seed, 4)) {
+            case 0:  ripple[i] = fuzz_decades(seed, -15, 0); break;
+            case 1:  ripple[i] = 100.0 - fuzz_decades(seed, -13, 1); break;
+            default: ripple[i] = 100.0*(1.0 - fuzz_uniform(seed)); break;
+        }
+    }
+    //Edge and garbage values for a field or two
+    for (int k = fuzz_below(seed, 3); k > 0; k--) {
+        int param = fuzz_below(seed, FUZZ_PARAMS);
+        *fuzz_input_field(in, param) = fuzz_random_value(seed, param, in);
+    }
+    fuzz_random_param(seed, c);
+}
+
+//Parameter for the tweak check, one the topology takes, and its new value
+static void fuzz_random_param(uint64_t *seed, fuzz_case *c) {
+    const tweak_graph *graph = tweak_graph_for(c->input.type);
+    unsigned inputs = graph ? graph->inputs : 0;
+    int param;
+
+    if (inputs == 0) {
+        c->param = 0;
+        return;
+    }
+    do {
+        param = fuzz_below(seed, FUZZ_PARAMS);
+    } while (!(inputs & (1u << param)));
+    c->param = 1u << param;
+    double old = *fuzz_input_field(&c->input, param);
+    switch (fuzz_below(seed, 4)) {
+        case 0:  c->value = fuzz_random_value(seed, param, &c->input); break;
+        case 1:  c->value = nextafter(old, fuzz_below(seed, 2) ? INFINITY : -INFINITY); break;
+        case 2:  c->value = old; break;    // no change at all
+        default: c->value = old*fuzz_decades(seed, -1, 1); break;
+    }
+}
+
+static void fuzz_mutate(uint64_t *seed, fuzz_case *c) {
+    for (int k = 1 + fuzz_below(seed, 3); k > 0; k--) {
+        int param = fuzz_below(seed, FUZZ_PARAMS);
+        double *field = fuzz_input_field(&c->input, param);
+        switch (fuzz_below(seed, 8)) {
+            case 0:
+                *field *= fuzz_decades(seed, -3, 3);
+                break;
+            case 1: {
+                //a few ulps either way
+                double toward = fuzz_below(seed, 2) ? INFINITY : -INFINITY;
+                for (int i = 1 + fuzz_below(seed, 16); i > 0; i--) {*field = nextafter(*field, toward);}
+                break;
+            }
+            case 2:
+                //the value of another field, the step and ripple limits are comparisons between them
+                *field = *fuzz_input_field(&c->input, fuzz_below(seed, FUZZ_PARAMS));
+                break;
+            case 3:
+                *field = fuzz_random_value(seed, param, &c->input);
+                break;
+            case 4: {
+                union {double d; uint64_t u;} bits = {*field};
+                bits.u ^= 1ULL << fuzz_below(seed, 64);
+                *field = bits.d;
+                break;
+            }
+            case 5:
+                c->input.type = (converter_type)fuzz_below(seed, 4);
+                break;
+            case 6:
+                fuzz_random_param(seed, c);
+                break;
+            default:
+                *field *= 1.0 + (fuzz_uniform(seed) - 0.5)*0.1;
+                break;
+        }
+    }
+    //The tweak parameter has to be one of the topology's
+    const tweak_graph *graph = tweak_graph_for(c->input.type);
+    if (graph && !(graph->inputs & c->param)) {
+        fuzz_random_param(seed, c);
+    }
+}
+
+static int fuzz_repro_fails(const fuzz_repro *r, const fuzz_options *opt) {
+    if (r->check == FUZZ_BATCH) {
+        unsigned failed[FUZZ_BLOCK] = {0};
+        fuzz_check_batch(r->block, r->n, opt, failed, -1);
+        return (failed[r->index] & FUZZ_BATCH) != 0;
+    }
+    fuzz_options only = *opt;
+    only.checks = r->check;
+    return (fuzz_check_case(&r->block[r->index], &only, 0) & r->check) != 0;
+}
+
+//Simpler values for x: fewer significant digits, 0 (clears a field the topology does not read), then
+//round numbers. A round number is never replaced by another, so shrinking cannot go round in circles.
+static int fuzz_simpler(double x, int step, double *out) {
+    static const double round[] = {1, 10, 100, 1000, 0.5};
+    int rounds = (int)(sizeof(round)/sizeof(round[0]));
+
+    if (!isfinite(x) || x == 0) {
+        return 0;
+    }
+    if (step == 4) {
+        *out = 0;
+        return 1;
+    }
+    for (int i = 0; i < rounds; i++) {
+        if (x == round[i]) {return 0;}
+    }
+    if (step < 4) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*g", step + 1, x);
+        *out = strtod(text, NULL);
+    } else if (step - 5 < rounds) {
+        *out = round[step - 5];
+    } else {
+        return 0;
+    }
+    return *out != x;
+}
+
+//Shrink a mismatch: drop the other cases of the batch, then make the values of the failing case
+//as simple as they can be while it still fails
+static void fuzz_minimize(fuzz_repro *r, const fuzz_options *opt) {
+    fuzz_repro trial;
+
+    if (r->check == FUZZ_BATCH) {
+        trial = *r;
+        trial.block[0] = r->block[r->index];
+        trial.n = 1;
+        trial.index = 0;
+        if (fuzz_repro_fails(&trial, opt)) {
+            *r = trial;
+        } else {
+            for (int i = r->n - 1; i >= 0; i--) {
+                if (i == r->index) {continue;}
+                trial = *r;
+                memmove(&trial.block[i], &trial.block[i + 1], (size_t)(trial.n - i - 1)*sizeof(fuzz_case));
+                trial.n--;
+                if (trial.index > i) {trial.index--;}
+                if (fuzz_repro_fails(&trial, opt)) {*r = trial;}
+            }
+        }
+    } else {
+        r->block[0] = r->block[r->index];
+        r->n = 1;
+        r->index = 0;
+    }
+    if (r->check != FUZZ_TWEAK) {
+        r->block[r->index].param = 0;
+        r->block[r->index].value = 0;
+    }
+    int progress = 1;
+    while (progress) {
+        progress = 0;
+        for (int field = 0; field <= FUZZ_PARAMS; field++) {
+            for (int step = 0; step < 10; step++) {
+                trial = *r;
+                fuzz_case *c = &trial.block[trial.index];
+                double *value = field < FUZZ_PARAMS ? fuzz_input_field(&c->input, field) : &c->value;
+                double simpler;
+                if (!fuzz_simpler(*value, step, &simpler)) {
+                    continue;
+                }
+                *value = simpler;
+                if (fuzz_repro_fails(&trial, opt)) {
+                    *r = trial;
+                    progress = 1;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+static void fuzz_report(fuzz_job *job, const fuzz_case *block, int n, int index, unsigned failed) {
+    for (int k = 0; k < FUZZ_CHECKS; k++) {
+        unsigned check = 1u << k;
+        if (!(failed & check)) {
+            continue;
+        }
+        job->mismatch[k]++;
+        if (__atomic_fetch_add(&fuzz_repros, 1, __ATOMIC_RELAXED) >= FUZZ_MAX_REPROS) {
+            continue;
+        }
+        fuzz_repro r;
+        char path[512];
+        memcpy(r.block, block, (size_t)n*sizeof(fuzz_case));
+        r.n = n;
+        r.index = index;
+        r.check = check;
+        fuzz_minimize(&r, job->opt);
+        pthread_mutex_lock(&fuzz_report_lock);
+        if (fuzz_write_repro(&r, job->opt->out_dir, path, sizeof(path))) {
+            printf("MISMATCH: %s check, reproducer in %s\n", fuzz_check_names[k], path);
+        } else {
+            printf("MISMATCH: %s check, could not write %s\n", fuzz_check_names[k], path);
+        }
+        fflush(stdout);
+        pthread_mutex_unlock(&fuzz_report_lock);
+    }
+}
+
+//%.17g reads back to the same double, NaN is written with its sign and payload so it does too
+static void fuzz_format(double x, char *text, size_t size) {
+    if (isnan(x)) {
+        union {double d; uint64_t u;} bits = {x};
+        snprintf(text, size, "%snan(0x%llx)", (bits.u >> 63) ? "-" : "",
+                 (unsigned long long)(bits.u & 0x000fffffffffffffULL));
+    } else {
+        snprintf(text, size, "%.17g", x);
+    }
+}
+
+//Reproducer: "key = value" lines as in a sweep spec, one [case] section per case of the batch.
+//The name is a hash of the contents, so the same minimized mismatch is written once.
+static int fuzz_write_repro(const fuzz_repro *r, const char *dir, char *path, size_t size) {
+    char text[FUZZ_BLOCK*512];
+    size_t len = 0;
+    uint64_t hash = 1469598103934665603ULL;
+
+    len += (size_t)snprintf(text + len, sizeof(text) - len,
+                            "# fuzz.out --repro <this file>\ncheck = %s\nindex = %d\n",
+                            fuzz_check_names[__builtin_ctz(r->check)], r->index);
+    for (int i = 0; i < r->n && len < sizeof(text) - 512; i++) {
+        const fuzz_case *c = &r->block[i];
+        len += (size_t)snprintf(text + len, sizeof(text) - len, "[case]\ntopology = %s\n",
+                                fuzz_type_names[c->input.type & 3]);
+        char value[48];
+        for (int p = 0; p < FUZZ_PARAMS; p++) {
+            fuzz_format(*fuzz_input_field((converter_input *)&c->input, p), value, sizeof(value));
+            len += (size_t)snprintf(text + len, sizeof(text) - len, "%s = %s\n", fuzz_param_names[p], value);
+        }
+        if (c->param) {
+            fuzz_format(c->value, value, sizeof(value));
+            len += (size_t)snprintf(text + len, sizeof(text) - len, "tweak = %s\nvalue = %s\n",
+                                    fuzz_param_names[__builtin_ctz(c->param)], value);
+        }
+    }
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (uint8_t)text[i])*1099511628211ULL;
+    }
+    snprintf(path, size, "%s/fuzz_%s_%016llx.txt", dir, fuzz_check_names[__builtin_ctz(r->check)],
+             (unsigned long long)hash);
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL) {
+        return 0;
+    }
+    fwrite(text, 1, len, fp);
+    fclose(fp);
+    return 1;
+}
+
+static int fuzz_read_repro(const char *path, fuzz_repro *r) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+
+    if (fp == NULL) {
+        printf("ERROR: cannot open %s\n", path);
+        return 0;
+    }
+    memset(r, 0, sizeof(*r));
+    while (fgets(line, sizeof(line), fp)) {
+        char key[32];
+        char value[128];
+        fuzz_case *c = r->n > 0 ? &r->block[r->n - 1] : NULL;
+        if (strncmp(line, "[case]", 6) == 0) {
+            if (r->n == FUZZ_BLOCK) {break;}
+            r->n++;
+            continue;
+        }
+        if (sscanf(line, " %31[a-z_0-9] = %127s", key, value) != 2) {
+            continue;
+        }
+        if (strcmp(key, "check") == 0) {
+            r->check = fuzz_parse_checks(value);
+        } else if (strcmp(key, "index") == 0) {
+            r->index = atoi(value);
+        } else if (c == NULL) {
+            continue;
+        } else if (strcmp(key, "topology") == 0) {
+            for (int t = 0; t < 4; t++) {
+                if (strcmp(value, fuzz_type_names[t]) == 0) {c->input.type = (converter_type)t;}
+            }
+        } else if (strcmp(key, "tweak") == 0) {
+            c->param = tweak_param_bit(value);
+        } else if (strcmp(key, "value") == 0) {
+            c->value = strtod(value, NULL);
+        } else {
+            tweak_set_param(&c->input, key, strtod(value, NULL));
+        }
+    }
+    fclose(fp);
+    if (r->n == 0 || r->index < 0 || r->index >= r->n || __builtin_popcount(r->check) != 1) {
+        printf("ERROR: %s is not a reproducer\n", path);
+        return 0;
+    }
+    return 1;
+}
+
+//Return 1 if the reproducer still fails
+static int fuzz_run_repro(const char *path, const fuzz_options *opt) {
+    fuzz_repro r;
+    if (!fuzz_read_repro(path, &r)) {
+        return 1;
+    }
+    int fails = fuzz_repro_fails(&r, opt);
+    printf("%s: %s check %s\n", path, fuzz_check_names[__builtin_ctz(r.check)], fails ? "FAILS" : "passes");
+    if (fails) {
+        if (r.check == FUZZ_BATCH) {
+            unsigned failed[FUZZ_BLOCK] = {0};
+            fuzz_check_batch(r.block, r.n, opt, failed, r.index);
+        } else {
+            fuzz_options only = *opt;
+            only.checks = r.check;
+            fuzz_check_case(&r.block[r.index], &only, 1);
+        }
+    }
+    return fails;
+}
+
+//Field of converter_input for a TWEAK_ bit index, in the order of fuzz_param_names
+static double *fuzz_input_field(converter_input *input, int param) {
+    switch (param) {
+        case 0:  return &input->vin_min;
+        case 1:  return &input->vin_max;
+        case 2:  return &input->v_out;
+        case 3:  return &input->p_out;
+        case 4:  return &input->f_switch;
+        case 5:  return &input->ripple_i_percent;
+        case 6:  return &input->ripple_i_1_percent;
+        case 7:  return &input->ripple_i_2_percent;
+        case 8:  return &input->ripple_v_percent;
+        default: return &input->ripple_v_cn_percent;
+    }
+}
+
+static unsigned fuzz_parse_checks(const char *text) {
+    unsigned checks = 0;
+    for (int k = 0; k < FUZZ_CHECKS; k++) {
+        const char *at = strstr(text, fuzz_check_names[k]);
+        if (at != NULL) {checks |= 1u << k;}
+    }
+    return checks;
+}
+
+static double fuzz_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+static void fuzz_usage(void) {
+    printf("Usage: fuzz.out [--seconds S] [--cases N] [--jobs J] [--seed X]\n"
+           "                [--checks batch,tweak,float,fixed,profile,loss]\n"
+           "                [--tolerance %%] [--fixed-tolerance %%] [--out dir]\n"
+           "       fuzz.out --repro <file>...\n");
+}
@@ -0,0 +1,387 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "loss.h"
+//Loss model and efficiency maps. L and C come from *_calculate, the operating point moves over Vin and Pout.
+//CCM equations are used everywhere, so losses at very light load (DCM) are underestimated and those points are flagged.
+
+//Operating point at one Vin with the inductance fixed by the design
+typedef struct {
+    double vin;
+    double duty;
+    double ripple;         // inductor ripple at the design L (L1 for cuk)
+    double ripple_2;       // cuk L2 ripple
+    double amps_per_watt;  // average inductor current per watt of load, worst of L1 and L2 for cuk
+    double i_LB;           // boundary current, DCM when amps_per_watt*Pout <= i_LB
+} loss_row;
+
+typedef struct {
+    const loss_design *design;
+    const loss_grid *grid;
+    double *eff;
+    unsigned char *dcm;
+    int first_tile;
+    int step;
+} loss_worker;
+
+static void loss_row_build(const loss_design *design, double vin, loss_row *row);
+static void loss_point(const loss_design *design, const loss_row *row, double p_out, loss_result *loss);
+static void loss_tile(const loss_design *design, const loss_grid *grid, double *eff, unsigned char *dcm, int tile);
+static void *loss_worker_run(void *arg);
+static int  loss_read_value(const char *prompt, double *value);
+static int  loss_read_params(loss_params *params);
+static void loss_print_result(const loss_result *loss, double vin, double p_out);
+static void loss_save_map(const loss_grid *grid, const double *eff, const unsigned char *dcm);
+
+void efficiency_map(void) {
+    converter_input input = {0};
+    converter_result result = {0};
+    loss_params params = {0};
+    loss_design design;
+    loss_grid grid = {0};
+    loss_row row;
+    loss_result loss;
+
+    printf("\n>> Efficiency Map\n");
+    if (!converter_read_design(&input, &result)) {
+        return;
+    }
+    if (!loss_read_params(&params)) {
+        return;
+    }
+    printf("Enter number of Vin points: ");
+    if (scanf("%d", &grid.vin_points) != 1) {grid.vin_points = 0;}
+    printf("Enter minimum output power for the map: ");
+    if (scanf("%lf", &grid.p_lo) != 1) {grid.p_lo = 0;}
+    printf("Enter number of Pout points: ");
+    if (scanf("%d", &grid.p_points) != 1) {grid.p_points = 0;}
+    grid.vin_lo = input.vin_min;
+    grid.vin_hi = input.vin_max;
+    grid.p_hi = input.p_out;
+    if (grid.vin_points < 1 || grid.p_points < 1 || !(grid.p_lo > 0) || grid.p_lo > grid.p_hi) {
+        printf("ERROR: Grid needs at least 1 point per axis and 0 < Pout min <= Pout!\n");
+        return;
+    }
+
+    loss_build_design(&input, &result, &params, &design);
+    loss_row_build(&design, input.vin_min, &row);
+    loss_point(&design, &row, input.p_out, &loss);
+    loss_print_result(&loss, input.vin_min, input.p_out);
+
+    size_t points = (size_t)grid.vin_points*(size_t)grid.p_points;
+    double *eff = malloc(points*sizeof(double));
+    unsigned char *dcm = malloc(points);
+    if (!eff || !dcm) {
+        printf("ERROR: Not enough memory for %zu points!\n", points);
+        free(eff);
+        free(dcm);
+        return;
+    }
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    loss_efficiency_map(&design, &grid, eff, dcm, threads);
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double ms = (stop.tv_sec - start.tv_sec)*1e3 + (stop.tv_nsec - start.tv_nsec)/1e6;
+
+    double eff_min = eff[0];
+    double eff_max = eff[0];
+    double eff_sum = 0;
+    size_t dcm_points = 0;
+    for (size_t i = 0; i < points; i++) {
+        if (eff[i] < eff_min) {eff_min = eff[i];}
+        if (eff[i] > eff_max) {eff_max = eff[i];}
+        eff_sum += eff[i];
+        dcm_points += dcm[i];
+    }
+    printf("\n========== EFFICIENCY MAP ==========\n");
+    printf("Grid                                  = %d x %d points\n", grid.vin_points, grid.p_points);
+    printf("Vin range                             = %.2f - %.2f V\n", grid.vin_lo, grid.vin_hi);
+    printf("Pout range                            = %.2f - %.2f W\n", grid.p_lo, grid.p_hi);
+    printf("Evaluation time                       = %.3f ms on %d threads\n", ms, threads);
+    printf("Minimum efficiency                    = %.2f %%\n", eff_min*100.0);
+    printf("Maximum efficiency                    = %.2f %%\n", eff_max*100.0);
+    printf("Mean efficiency                       = %.2f %%\n", eff_sum/points*100.0);
+    if (dcm_points > 0) {
+        printf("DCM points (losses underestimated)    = %zu\n", dcm_points);
+    }
+
+    char answer_for_saving;
+    printf("\nSave map to file? (y/n): ");
+    if (scanf(" %c", &answer_for_saving) == 1 && ((answer_for_saving == 'y') || (answer_for_saving == 'Y'))) {
+        loss_save_map(&grid, eff, dcm);
+    }
+    free(eff);
+    free(dcm);
+}
+
+static int loss_read_value(const char *prompt, double *value) {
+    printf("%s", prompt);
+    if (scanf("%lf", value) != 1 || !isfinite(*value) || *value < 0) {
+        printf("ERROR: Device parameters must be numbers >= 0!\n");
+        return 0;
+    }
+    return 1;
+}
+
+//Return 0 as soon as one parameter is missing, negative or not finite
+static int loss_read_params(loss_params *params) {
+    return loss_read_value("Enter switch on resistance (Ohm): ", &params->r_ds_on)
+        && loss_read_value("Enter switch rise time (s): ", &params->t_rise)
+        && loss_read_value("Enter switch fall time (s): ", &params->t_fall)
+        && loss_read_value("Enter diode forward voltage (V): ", &params->v_f)
+        && loss_read_value("Enter inductor DC resistance (Ohm): ", &params->r_dcr)
+        && loss_read_value("Enter capacitor ESR (Ohm): ", &params->r_esr);
+}
+
+void loss_build_design(const converter_input *input, const converter_result *result,
+                       const loss_params *params, loss_design *design) {
+    design->input = *input;
+    if (input->type == cuk_conv) {
+        design->L = result->L1;
+        design->L2 = result->L2;
+    }
+    else {
+        design->L = result->L;
+        design->L2 = 0;
+    }
+    design->params = *params;
+}
+
+//Evaluate the library at this Vin for the duty cycle and ripple. It sizes L for the ripple given in the input,
+//L*ripple is the volt-seconds over f, so the ripple at the design L is rescaled from that.
+static void loss_row_build(const loss_design *design, double vin, loss_row *row) {
+    converter_input input = design->input;
+    converter_result op = {0};
+    input.vin_min = vin;
+    input.vin_max = vin;
+    converter_calculate(&input, &op);
+    row->vin = vin;
+    row->duty = op.duty_cycle;
+    row->ripple_2 = 0;
+    switch (input.type) {
+        case buck_conv:
+            row->ripple = op.ripple_i_L*op.L/design->L;
+            row->amps_per_watt = 1.0/input.v_out;
+            break;
+        case boost_conv:
+            row->ripple = op.ripple_i_L*op.L/design->L;
+            row->amps_per_watt = 1.0/vin;
+            break;
+        case buck_boost_conv:
+            row->ripple = op.ripple_i_L*op.L/design->L;
+            row->amps_per_watt = 1.0/(input.v_out*(1.0 - op.duty_cycle));
+            break;
+        default:
+            //cuk_calculate keeps no ripple, the volt-seconds are Vin*D on L1 and Vout*(1-D) on L2
+            row->ripple = vin*op.duty_cycle/(design->L*input.f_switch);
+            row->ripple_2 = input.v_out*(1.0 - op.duty_cycle)/(design->L2*input.f_switch);
+            //worst of IL1 and IL2, same as cuk_analyse
+            row->amps_per_watt = fmax(1.0/vin, 1.0/input.v_out);
+            break;
+    }
+    row->i_LB = fmax(row->ripple, row->ripple_2)/2.0;
+}
+
+//Equations from 2501 with the inductance fixed, so the ripple follows Vin.
+//The diode carries the switch current during (1-D) in all four topologies.
+static void loss_point(const loss_design *design, const loss_row *row, double p_out, loss_result *loss) {
+    const loss_params *k = &design->params;
+    double v_out = design->input.v_out;
+    double f = design->input.f_switch;
+    double vin = row->vin;
+    double duty = row->duty;
+    double ripple_sw = row->ripple;
+    double i_out = p_out/v_out;
+    double i_sw, v_sw, i_ind_sq, i_cap_sq;
+
+    switch (design->input.type) {
+        case buck_conv:
+            i_sw = i_out;
+            v_sw = vin;
+            i_ind_sq = i_sw*i_sw + ripple_sw*ripple_sw/12.0;
+            i_cap_sq = ripple_sw*ripple_sw/12.0;
+            break;
+        case boost_conv:
+            i_sw = p_out/vin;
+            v_sw = v_out;
+            i_ind_sq = i_sw*i_sw + ripple_sw*ripple_sw/12.0;
+            i_cap_sq = i_out*i_out*duty/(1.0 - duty);
+            break;
+        case buck_boost_conv:
+            i_sw = i_out/(1.0 - duty);
+            v_sw = vin + v_out;
+            i_ind_sq = i_sw*i_sw + ripple_sw*ripple_sw/12.0;
+            i_cap_sq = i_out*i_out*duty/(1.0 - duty);
+            break;
+        default: {
+            //cuk: switch carries IL1 + IL2, Cn sees IL1 in the off time and IL2 in the on time
+            double i_1 = p_out/vin;
+            double ripple_1 = row->ripple;
+            double ripple_2 = row->ripple_2;
+            i_sw = i_1 + i_out;
+            ripple_sw = ripple_1 + ripple_2;
+            v_sw = vin + v_out;
+            i_ind_sq = i_1*i_1 + ripple_1*ripple_1/12.0 + i_out*i_out + ripple_2*ripple_2/12.0;
+            i_cap_sq = ripple_2*ripple_2/12.0 + (1.0 - duty)*i_1*i_1 + duty*i_out*i_out;
+            break;
+        }
+    }
+    loss->p_conduction = k->r_ds_on*duty*(i_sw*i_sw + ripple_sw*ripple_sw/12.0);
+    loss->p_switching = 0.5*v_sw*i_sw*(k->t_rise + k->t_fall)*f;
+    loss->p_diode = k->v_f*(1.0 - duty)*i_sw;
+    loss->p_inductor = k->r_dcr*i_ind_sq;
+    loss->p_capacitor = k->r_esr*i_cap_sq;
+    loss->p_total = loss->p_conduction + loss->p_switching + loss->p_diode + loss->p_inductor + loss->p_capacitor;
+    loss->efficiency = p_out/(p_out + loss->p_total);
+    loss->is_ccm = row->amps_per_watt*p_out > row->i_LB;
+}
+
+//Fill eff (row-major, vin_points rows of p_points) using up to threads workers.
+//dcm may be NULL, otherwise dcm[i] is 1 where point i is in DCM and its losses are underestimated.
+//Tiles are dealt round-robin so each worker writes its own blocks and no locking is needed.
+int loss_efficiency_map(const loss_design *design, const loss_grid *grid, double *eff, unsigned char *dcm, int threads) {
+    int tile_rows = (grid->vin_points + LOSS_TILE - 1)/LOSS_TILE;
+    int tile_cols = (grid->p_points + LOSS_TILE - 1)/LOSS_TILE;
+    int tiles = tile_rows*tile_cols;
+    if (threads > tiles) {threads = tiles;}
+    if (threads < 1) {threads = 1;}
+
+    pthread_t *ids = malloc(threads*sizeof(pthread_t));
+    loss_worker *workers = malloc(threads*sizeof(loss_worker));
+    if (!ids || !workers) {
+        free(ids);
+        free(workers);
+        return 0;
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i].design = design;
+        workers[i].grid = grid;
+        workers[i].eff = eff;
+        workers[i].dcm = dcm;
+        workers[i].first_tile = i;
+        workers[i].step = threads;
+    }
+    //worker 0 runs on the calling thread
+    int started = 1;
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&ids[i], NULL, loss_worker_run, &workers[i]) != 0) {
+            break;
+        }
+        started++;
+    }
+    for (int i = started; i < threads; i++) {
+        loss_worker_run(&workers[i]); // could not start a thread, do its tiles here
+    }
+    loss_worker_run(&workers[0]);
+    for (int i = 1; i < started; i++) {
+        pthread_join(ids[i], NULL);
+    }
+    free(ids);
+    free(workers);
+    return 1;
+}
+
+static void *loss_worker_run(void *arg) {
+    loss_worker *worker = arg;
+    int tile_cols = (worker->grid->p_points + LOSS_TILE - 1)/LOSS_TILE;
+    int tiles = ((worker->grid->vin_points + LOSS_TILE - 1)/LOSS_TILE)*tile_cols;
+    for (int tile = worker->first_tile; tile < tiles; tile += worker->step) {
+        loss_tile(worker->design, worker->grid, worker->eff, worker->dcm, tile);
+    }
+    return NULL;
+}
+
+static void loss_tile(const loss_design *design, const loss_grid *grid, double *eff, unsigned char *dcm, int tile) {
+    int tile_cols = (grid->p_points + LOSS_TILE - 1)/LOSS_TILE;
+    int row_first = (tile/tile_cols)*LOSS_TILE;
+    int col_first = (tile%tile_cols)*LOSS_TILE;
+    int row_last = row_first + LOSS_TILE;
+    int col_last = col_first + LOSS_TILE;
+    if (row_last > grid->vin_points) {row_last = grid->vin_points;}
+    if (col_last > grid->p_points) {col_last = grid->p_points;}
+    double vin_step = grid->vin_points > 1 ? (grid->vin_hi - grid->vin_lo)/(grid->vin_points - 1) : 0;
+    double p_step = grid->p_points > 1 ? (grid->p_hi - grid->p_lo)/(grid->p_points - 1) : 0;
+
+    //At fixed Vin every CCM loss term is a + b*Pout + c*Pout^2, so fit the row from three exact points
+    //and let the inner loop run without branches or per-topology work.
+    //The ripple does not move with Pout, so DCM is everything below one boundary power per row.
+    double p_mid = 0.5*(grid->p_lo + grid->p_hi);
+    double p_half = 0.5*(grid->p_hi - grid->p_lo);
+    for (int row = row_first; row < row_last; row++) {
+        double vin = grid->vin_lo + row*vin_step;
+        double *out = eff + (size_t)row*grid->p_points;
+        loss_row op;
+        loss_result lo, mid, hi;
+        loss_row_build(design, vin, &op);
+        loss_point(design, &op, p_mid - p_half, &lo);
+        loss_point(design, &op, p_mid, &mid);
+        loss_point(design, &op, p_mid + p_half, &hi);
+        double a = mid.p_total;
+        double b = 0;
+        double c = 0;
+        if (p_half > 0) {
+            b = (hi.p_total - lo.p_total)/(2.0*p_half);
+            c = (hi.p_total - 2.0*mid.p_total + lo.p_total)/(2.0*p_half*p_half);
+        }
+        if (isfinite(a) && isfinite(b) && isfinite(c)) {
+            for (int col = col_first; col < col_last; col++) {
+                double x = grid->p_lo + col*p_step - p_mid;
+                double p_out = p_mid + x;
+                out[col] = p_out/(p_out + a + x*(b + x*c));
+            }
+        }
+        else {
+            //an infinite loss (D rounded to 1) would fit as inf - inf, so the row takes the equations point by point
+            for (int col = col_first; col < col_last; col++) {
+                double p_out = grid->p_lo + col*p_step;
+                loss_result point;
+                loss_point(design, &op, p_out, &point);
+                out[col] = p_out/(p_out + point.p_total);
+            }
+        }
+        if (dcm) {
+            unsigned char *flag = dcm + (size_t)row*grid->p_points;
+            for (int col = col_first; col < col_last; col++) {
+                flag[col] = op.amps_per_watt*(grid->p_lo + col*p_step) <= op.i_LB;
+            }
+        }
+    }
+}
+
+static void loss_print_result(const loss_result *loss, double vin, double p_out) {
+    printf("\n========== LOSSES AT Vin = %.2f V, Pout = %.2f W ==========\n", vin, p_out);
+    printf("Switch conduction loss                = %.3f W\n", loss->p_conduction);
+    printf("Switch switching loss                 = %.3f W\n", loss->p_switching);
+    printf("Diode loss                            = %.3f W\n", loss->p_diode);
+    printf("Inductor DCR loss                     = %.3f W\n", loss->p_inductor);
+    printf("Capacitor ESR loss                    = %.3f W\n", loss->p_capacitor);
+    printf("Total loss                            = %.3f W\n", loss->p_total);
+    printf("Efficiency                            = %.2f %%\n", loss->efficiency*100.0);
+    if (!loss->is_ccm) {
+        printf("Operating point is in DCM, the CCM equations underestimate these losses\n");
+    }
+}
+
+static void loss_save_map(const loss_grid *grid, const double *eff, const unsigned char *dcm) {
+    FILE *fp = fopen("efficiency_map.txt", "w");
+    if (!fp) {
+        perror("fopen");
+        return;
+    }
+    double vin_step = grid->vin_points > 1 ? (grid->vin_hi - grid->vin_lo)/(grid->vin_points - 1) : 0;
+    double p_step = grid->p_points > 1 ? (grid->p_hi - grid->p_lo)/(grid->p_points - 1) : 0;
+    fprintf(fp, "Vin, Pout, efficiency, dcm\n");
+    for (int row = 0; row < grid->vin_points; row++) {
+        for (int col = 0; col < grid->p_points; col++) {
+            size_t i = (size_t)row*grid->p_points + col;
+            fprintf(fp, "%.4f, %.4f, %.6f, %d\n", grid->vin_lo + row*vin_step, grid->p_lo + col*p_step,
+                    eff[i], dcm[i]);
+        }
+    }
+    fclose(fp);
+    printf("Map saved to efficiency_map.txt\n");
+}
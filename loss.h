@@ -0,0 +1,53 @@
+#ifndef LOSS_H
+#define LOSS_H
+
+#include "funcs.h"
+
+#define LOSS_TILE 64  // map tiles are LOSS_TILE x LOSS_TILE points
+
+//Device parameters supplied by the user
+typedef struct {
+    double r_ds_on;  // switch on resistance (Ohm)
+    double t_rise;   // switch rise time (s)
+    double t_fall;   // switch fall time (s)
+    double v_f;      // diode forward voltage (V)
+    double r_dcr;    // inductor DC resistance (Ohm), same for L1 and L2
+    double r_esr;    // capacitor ESR (Ohm), same for Co and Cn
+} loss_params;
+
+//Loss breakdown at one operating point
+typedef struct {
+    double p_conduction; // switch conduction
+    double p_switching;  // switch turn-on and turn-off
+    double p_diode;
+    double p_inductor;   // DCR
+    double p_capacitor;  // ESR with RMS ripple current
+    double p_total;
+    double efficiency;   // Pout/(Pout + losses)
+    int    is_ccm;       // 0 in DCM, where the CCM equations underestimate the losses
+} loss_result;
+
+//Fixed parts of a finished design the loss equations need
+typedef struct {
+    converter_input input; // the design, the map moves Vin and Pout away from it
+    double L;   // L for buck, boost, buck-boost and L1 for cuk
+    double L2;  // cuk only
+    loss_params params;
+} loss_design;
+
+//Vin x Pout grid, both ends included
+typedef struct {
+    double vin_lo;
+    double vin_hi;
+    int    vin_points;
+    double p_lo;
+    double p_hi;
+    int    p_points;
+} loss_grid;
+
+void efficiency_map(void);
+void loss_build_design(const converter_input *input, const converter_result *result,
+                       const loss_params *params, loss_design *design);
+int  loss_efficiency_map(const loss_design *design, const loss_grid *grid, double *eff, unsigned char *dcm, int threads);
+
+#endif
@@ -0,0 +1,416 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "magnetics.h"
+//Magnetics stage: pick a core, turns and wire for each inductor of a design from the database in cores.txt.
+//For every core the turns run from the least that reach L without saturating to the most that still fit
+//the window at the current density limit. Core loss falls with the turns and copper loss at the DC current
+//only rises, so the turns loop stops as soon as that alone loses to the best design, and a whole core is
+//skipped when its best case (core loss at the most turns plus copper loss at the fewest) cannot win.
+//Copper loss uses DC resistance only (no skin or proximity effect) and powder cores keep their AL under
+//DC bias, so both are optimistic at high frequency and high current.
+
+typedef struct {
+    const mag_db *db;
+    const mag_limits *limits;
+    const mag_inductor *inductor;
+    mag_choice *choice;
+    size_t n;
+    size_t first_block;
+    size_t step;
+    size_t found;
+} mag_worker;
+
+static int  mag_compare_core(const void *a, const void *b);
+static int  mag_compare_wire(const void *a, const void *b);
+static int  mag_fit_wire(const mag_db *db, double window, int turns);
+static void *mag_worker_run(void *arg);
+static void mag_print_choice(const mag_db *db, const mag_inductor *inductor, const mag_choice *choice,
+                             const mag_stats *stats, double us);
+
+void magnetics_design(void) {
+    converter_input input = {0};
+    converter_result result = {0};
+    mag_limits limits = {0};
+    mag_inductor inductor[2];
+    int objective = 0;
+
+    printf("\n>> Magnetics Design\n");
+    mag_db *db = malloc(sizeof(mag_db));
+    if (!db) {
+        printf("ERROR: Not enough memory for the core database!\n");
+        return;
+    }
+    if (!mag_load_db(MAG_DB, db)) {
+        free(db);
+        return;
+    }
+    printf("%d cores and %d wire gauges in %s\n", db->cores, db->gauges, MAG_DB);
+    if (!converter_read_design(&input, &result)) {
+        free(db);
+        return;
+    }
+    printf("Enter maximum current density (A/mm^2): ");
+    if (scanf("%lf", &limits.j_max) != 1) {
+        printf("\nInvalid input\n");
+        free(db);
+        return;
+    }
+    printf("Optimise for (1 = loss, 2 = volume): ");
+    if (scanf("%d", &objective) != 1) {
+        printf("\nInvalid input\n");
+        free(db);
+        return;
+    }
+    if (!(limits.j_max > 0) || (objective != 1 && objective != 2)) {
+        printf("ERROR: Current density must be positive and the choice 1 or 2!\n");
+        free(db);
+        return;
+    }
+    limits.objective = objective == 2 ? mag_min_volume : mag_min_loss;
+
+    int count = mag_inductors(&input, &result, inductor);
+    for (int i = 0; i < count; i++) {
+        mag_choice choice;
+        mag_stats stats = {0};
+        struct timespec start, stop;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        mag_search(db, &limits, &inductor[i], &choice, &stats);
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        double us = (stop.tv_sec - start.tv_sec)*1e6 + (stop.tv_nsec - start.tv_nsec)/1e3;
+        mag_print_choice(db, &inductor[i], &choice, &stats, us);
+    }
+    free(db);
+}
+
+//Database file, '#' starts a comment:
+//  core <name> <material> <Ae mm^2> <le mm> <AL nH> <Bsat T> <Wa mm^2> <MLT mm> <gapped 0/1> <k> <alpha> <beta>
+//  wire <name> <bare diameter mm> <insulated diameter mm>
+int mag_load_db(const char *path, mag_db *db) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int line_no = 0;
+    double bare[MAG_MAX_GAUGES];
+    double insulated[MAG_MAX_GAUGES];
+
+    if (!fp) {
+        perror("fopen");
+        return 0;
+    }
+    memset(db, 0, sizeof(*db));
+    while (fgets(line, sizeof(line), fp)) {
+        char kind[8];
+        line_no++;
+        line[strcspn(line, "#\r\n")] = '\0';
+        if (sscanf(line, " %7s", kind) != 1) {
+            continue;
+        }
+        if (strcmp(kind, "core") == 0 && db->cores < MAG_MAX_CORES) {
+            mag_core *c = &db->core[db->cores];
+            if (sscanf(line, " core %31s %15s %lf %lf %lf %lf %lf %lf %d %lf %lf %lf", c->name, c->material,
+                       &c->ae, &c->le, &c->al, &c->b_sat, &c->wa, &c->mlt, &c->gapped, &c->k, &c->alpha, &c->beta) == 12
+                && c->ae > 0 && c->le > 0 && c->al > 0 && c->b_sat > 0 && c->wa > 0 && c->mlt > 0) {
+                db->cores++;
+                continue;
+            }
+        }
+        else if (strcmp(kind, "wire") == 0 && db->gauges < MAG_MAX_GAUGES) {
+            int g = db->gauges;
+            if (sscanf(line, " wire %15s %lf %lf", db->gauge[g], &bare[g], &insulated[g]) == 3
+                && bare[g] > 0 && insulated[g] >= bare[g]) {
+                db->gauges++;
+                continue;
+            }
+        }
+        printf("ERROR: %s:%d bad or too many entries\n", path, line_no);
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+    if (db->cores == 0 || db->gauges == 0) {
+        printf("ERROR: %s needs at least one core and one wire\n", path);
+        return 0;
+    }
+    qsort(db->core, (size_t)db->cores, sizeof(db->core[0]), mag_compare_core);
+
+    //Every gauge with 1 to MAG_MAX_STRANDS strands, by window area, with the most copper that fits any area
+    for (int g = 0; g < db->gauges; g++) {
+        for (int s = 1; s <= MAG_MAX_STRANDS; s++) {
+            mag_wire *w = &db->wire[db->wires++];
+            w->gauge = g;
+            w->strands = s;
+            w->copper = s*M_PI/4.0*bare[g]*bare[g];
+            w->area = s*M_PI/4.0*insulated[g]*insulated[g];
+        }
+    }
+    qsort(db->wire, (size_t)db->wires, sizeof(db->wire[0]), mag_compare_wire);
+    for (int i = 0; i < db->wires; i++) {
+        db->best_wire[i] = i;
+        if (i > 0 && db->best_copper[i - 1] >= db->wire[i].copper) {
+            db->best_wire[i] = db->best_wire[i - 1];
+        }
+        db->best_copper[i] = db->wire[db->best_wire[i]].copper;
+    }
+    return 1;
+}
+
+//The inductors of a design with their currents at Vin_min, taken from the input so the float and
+//fixed-point calculators (which leave ripple_i_L and i_L_peak empty) can be used too. Return the count.
+int mag_inductors(const converter_input *input, const converter_result *result, mag_inductor *inductor) {
+    double i_out = input->p_out/input->v_out;
+    double i_in = input->p_out/input->vin_min;
+    double duty;
+
+    inductor[0].name = "L";
+    inductor[0].L = result->L;
+    inductor[0].f_switch = input->f_switch;
+    switch (input->type) {
+        case buck_conv:
+            inductor[0].i_avg = i_out;
+            break;
+        case boost_conv:
+            inductor[0].i_avg = i_in;
+            break;
+        case buck_boost_conv:
+            duty = input->v_out/(input->vin_min + input->v_out);
+            inductor[0].i_avg = i_out/(1.0 - duty);
+            break;
+        case cuk_conv:
+            inductor[0].name = "L1";
+            inductor[0].L = result->L1;
+            inductor[0].i_avg = i_in;
+            inductor[0].ripple = i_in*input->ripple_i_1_percent/100.0;
+            inductor[1].name = "L2";
+            inductor[1].L = result->L2;
+            inductor[1].i_avg = i_out;
+            inductor[1].ripple = i_out*input->ripple_i_2_percent/100.0;
+            inductor[1].f_switch = input->f_switch;
+            return 2;
+    }
+    inductor[0].ripple = inductor[0].i_avg*input->ripple_i_percent/100.0;
+    return 1;
+}
+
+//Best core, turns and wire for one inductor. Return 0 (choice->core = -1) if nothing in the database fits.
+int mag_search(const mag_db *db, const mag_limits *limits, const mag_inductor *inductor, mag_choice *choice, mag_stats *stats) {
+    const double L = inductor->L;
+    const double f = inductor->f_switch;
+    double best = HUGE_VAL;
+    double best_volume = HUGE_VAL;
+    long pruned = 0, tried = 0, turns_tried = 0;
+
+    memset(choice, 0, sizeof(*choice));
+    choice->core = -1;
+    if (!(L > 0) || !(f > 0) || inductor->i_avg < 0 || inductor->ripple < 0) {
+        return 0;
+    }
+    double i_rms_sq = inductor->i_avg*inductor->i_avg + inductor->ripple*inductor->ripple/12.0;
+    double copper_min = sqrt(i_rms_sq)/limits->j_max;
+    //Smallest window area of any wire that meets the current density
+    double area_min = HUGE_VAL;
+    for (int w = 0; w < db->wires; w++) {
+        if (db->wire[w].copper >= copper_min && db->wire[w].area < area_min) {area_min = db->wire[w].area;}
+    }
+    if (area_min == HUGE_VAL) {
+        return 0;
+    }
+
+    for (int c = 0; c < db->cores; c++) {
+        const mag_core *core = &db->core[c];
+        double volume = core->ae*core->le;
+        if (limits->objective == mag_min_volume && volume > best_volume) {
+            break;   // sorted by volume, nothing later can be smaller
+        }
+        double ae = core->ae*1e-6;
+        double al = core->al*1e-9;
+        double b_max = MAG_B_MARGIN*core->b_sat;
+        double window = MAG_FILL*core->wa;
+        double n_fit = floor(window/area_min);
+        double n_lo = ceil(sqrt(L/al)*(1.0 - 1e-12));
+        if (core->gapped) {
+            double n_sat = ceil(L*(inductor->i_avg + inductor->ripple/2.0)/(b_max*ae));
+            if (n_sat > n_lo) {n_lo = n_sat;}
+        }
+        if (n_lo < 1) {n_lo = 1;}
+        double n_hi = n_fit;
+        if (n_hi > MAG_MAX_TURNS) {n_hi = MAG_MAX_TURNS;}
+        if (n_lo > n_hi) {
+            pruned++;
+            continue;
+        }
+        //Core loss is pv_1*N^-beta: the flux swing L*ripple/(N*Ae) does not depend on the gap
+        double pv_1 = core->k*pow(f, core->alpha)*pow(L*inductor->ripple/(2.0*ae), core->beta)*volume*1e-9;
+        double core_floor = pv_1*pow(n_hi, -core->beta);
+        //A fixed AL core winds more than L, so its ripple and RMS current can only be lower, and fall
+        //further with every turn: more turns can lower its copper loss as well as its core loss
+        int w_lo = mag_fit_wire(db, window, (int)n_lo);
+        double floor_rms_sq = core->gapped ? i_rms_sq : inductor->i_avg*inductor->i_avg;
+        double copper_floor = floor_rms_sq*MAG_RHO_CU*n_lo*core->mlt/db->best_copper[w_lo];
+        if (core_floor + copper_floor >= best) {
+            pruned++;
+            continue;
+        }
+        tried++;
+
+        for (int n = (int)n_lo; n <= (int)n_hi; n++) {
+            turns_tried++;
+            double L_wound = core->gapped ? L : al*n*n;
+            double ripple = inductor->ripple*L/L_wound;
+            double b_peak = L_wound*(inductor->i_avg + ripple/2.0)/(n*ae);
+            if (b_peak > b_max) {
+                continue;
+            }
+            int w = mag_fit_wire(db, window, n);
+            if (w < 0 || db->best_copper[w] < copper_min) {
+                break;   // fewer turns fit thicker wire, so more turns will not fit either
+            }
+            if (floor_rms_sq*MAG_RHO_CU*n*core->mlt/db->best_copper[w] + core_floor >= best) {
+                break;   // the copper floor only grows with the turns
+            }
+            double rms_sq = inductor->i_avg*inductor->i_avg + ripple*ripple/12.0;
+            double p_copper = rms_sq*MAG_RHO_CU*n*core->mlt/db->best_copper[w];
+            double p_core = pv_1*pow(n, -core->beta);
+            if (p_copper + p_core < best) {
+                int wire = db->best_wire[w];
+                best = p_copper + p_core;
+                best_volume = volume;
+                choice->core = c;
+                choice->wire = wire;
+                choice->turns = n;
+                choice->L = L_wound;
+                choice->gap = core->gapped ? 4e-7*M_PI*ae*((double)n*n/L - 1.0/al)*1e3 : 0;
+                choice->b_peak = b_peak;
+                choice->b_ac = L*inductor->ripple/(2.0*n*ae);
+                choice->p_core = p_core;
+                choice->p_copper = p_copper;
+                choice->p_total = best;
+                choice->volume = volume;
+                choice->fill = n*db->wire[wire].area/core->wa;
+            }
+        }
+    }
+    if (stats) {
+        stats->cores_pruned += pruned;
+        stats->cores_tried += tried;
+        stats->turns_tried += turns_tried;
+    }
+    return choice->core >= 0;
+}
+
+//Search n inductors on up to threads workers, MAG_BLOCK at a time dealt round-robin.
+//Return how many found a core.
+size_t mag_search_batch(const mag_db *db, const mag_limits *limits, const mag_inductor *inductor,
+                        mag_choice *choice, size_t n, int threads) {
+    size_t blocks = (n + MAG_BLOCK - 1)/MAG_BLOCK;
+    if ((size_t)threads > blocks) {threads = (int)blocks;}
+    if (threads < 1) {threads = 1;}
+
+    mag_worker *workers = malloc(threads*sizeof(mag_worker));
+    pthread_t *ids = malloc(threads*sizeof(pthread_t));
+    if (!workers || !ids) {
+        threads = 1;
+    }
+    mag_worker single;
+    if (threads == 1) {
+        single = (mag_worker){db, limits, inductor, choice, n, 0, 1, 0};
+        mag_worker_run(&single);
+        free(workers);
+        free(ids);
+        return single.found;
+    }
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        workers[t] = (mag_worker){db, limits, inductor, choice, n, (size_t)t, (size_t)threads, 0};
+        if (pthread_create(&ids[t], NULL, mag_worker_run, &workers[t]) != 0) {
+            break;
+        }
+        started++;
+    }
+    //Any worker that did not start is run here
+    for (int t = started; t < threads; t++) {
+        mag_worker_run(&workers[t]);
+    }
+    size_t found = 0;
+    for (int t = 0; t < threads; t++) {
+        if (t < started) {pthread_join(ids[t], NULL);}
+        found += workers[t].found;
+    }
+    free(workers);
+    free(ids);
+    return found;
+}
+
+void mag_wire_name(const mag_db *db, int wire, char *name, size_t size) {
+    const mag_wire *w = &db->wire[wire];
+    if (w->strands == 1) {snprintf(name, size, "%s", db->gauge[w->gauge]);}
+    else {snprintf(name, size, "%dx%s", w->strands, db->gauge[w->gauge]);}
+}
+
+static void *mag_worker_run(void *arg) {
+    mag_worker *worker = arg;
+    size_t blocks = (worker->n + MAG_BLOCK - 1)/MAG_BLOCK;
+    for (size_t b = worker->first_block; b < blocks; b += worker->step) {
+        size_t end = (b + 1)*MAG_BLOCK;
+        if (end > worker->n) {end = worker->n;}
+        for (size_t i = b*MAG_BLOCK; i < end; i++) {
+            worker->found += (size_t)mag_search(worker->db, worker->limits, &worker->inductor[i], &worker->choice[i], NULL);
+        }
+    }
+    return NULL;
+}
+
+//Last wire (by window area) that fits the given turns, -1 if none does
+static int mag_fit_wire(const mag_db *db, double window, int turns) {
+    int lo = 0, hi = db->wires - 1, fit = -1;
+    while (lo <= hi) {
+        int mid = (lo + hi)/2;
+        if (db->wire[mid].area*turns <= window) {
+            fit = mid;
+            lo = mid + 1;
+        }
+        else {hi = mid - 1;}
+    }
+    return fit;
+}
+
+static int mag_compare_core(const void *a, const void *b) {
+    const mag_core *ca = a, *cb = b;
+    double va = ca->ae*ca->le, vb = cb->ae*cb->le;
+    return (va > vb) - (va < vb);
+}
+
+static int mag_compare_wire(const void *a, const void *b) {
+    const mag_wire *wa = a, *wb = b;
+    return (wa->area > wb->area) - (wa->area < wb->area);
+}
+
+static void mag_print_choice(const mag_db *db, const mag_inductor *inductor, const mag_choice *choice,
+                             const mag_stats *stats, double us) {
+    printf("\n========== MAGNETICS: %s = %.6e H ==========\n", inductor->name, inductor->L);
+    printf("Average current                       = %.3f A\n", inductor->i_avg);
+    printf("Current ripple                        = %.3f A\n", inductor->ripple);
+    printf("Search                                = %ld cores tried, %ld pruned, %ld turn counts in %.1f us\n",
+           stats->cores_tried, stats->cores_pruned, stats->turns_tried, us);
+    if (choice->core < 0) {
+        printf("WARNING: No core in %s fits this inductor!\n", MAG_DB);
+        return;
+    }
+    const mag_core *core = &db->core[choice->core];
+    char wire[32];
+    mag_wire_name(db, choice->wire, wire, sizeof(wire));
+    printf("Core                                  = %s (%s)\n", core->name, core->material);
+    printf("Turns                                 = %d\n", choice->turns);
+    printf("Wire                                  = %s\n", wire);
+    printf("Wound inductance                      = %.6e H\n", choice->L);
+    if (core->gapped) {printf("Air gap                               = %.3f mm\n", choice->gap);}
+    printf("Peak flux density                     = %.3f T (Bsat %.2f T)\n", choice->b_peak, core->b_sat);
+    printf("AC flux density                       = %.4f T\n", choice->b_ac);
+    printf("Core loss                             = %.4f W\n", choice->p_core);
+    printf("Copper loss                           = %.4f W\n", choice->p_copper);
+    printf("Total loss                            = %.4f W\n", choice->p_total);
+    printf("Core volume                           = %.2f cm^3\n", choice->volume/1000.0);
+    printf("Window fill                           = %.1f %%\n", choice->fill*100.0);
+}
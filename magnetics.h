@@ -0,0 +1,99 @@
+#ifndef MAGNETICS_H
+#define MAGNETICS_H
+
+#include "funcs.h"
+
+#define MAG_DB           "cores.txt"
+#define MAG_MAX_CORES    64
+#define MAG_MAX_GAUGES   32
+#define MAG_MAX_STRANDS  16     // parallel strands of one gauge
+#define MAG_MAX_TURNS    1000
+#define MAG_BLOCK        256    // inductors per work unit in a batch
+#define MAG_FILL         0.4    // copper fill of the window, bobbin and insulation take the rest
+#define MAG_B_MARGIN     0.8    // peak flux density as a fraction of Bsat
+#define MAG_RHO_CU       2.3e-5 // copper at 100 C (Ohm mm^2/mm)
+
+//Core from the database. Units as in cores.txt: mm, mm^2, nH per turn^2, T.
+typedef struct {
+    char name[32];
+    char material[16];
+    double ae;          // effective area (mm^2)
+    double le;          // magnetic path length (mm)
+    double al;          // inductance factor (nH/N^2), without gap for ferrite
+    double b_sat;       // saturation flux density (T)
+    double wa;          // window area (mm^2)
+    double mlt;         // mean length of turn (mm)
+    int gapped;         // 1 = air gap can be ground to any AL below al, 0 = fixed AL (powder)
+    double k;           // Steinmetz: Pv = k*f^alpha*B^beta in W/m^3, f in Hz, B (peak) in T
+    double alpha;
+    double beta;
+} mag_core;
+
+//Winding option: strands of one gauge in parallel
+typedef struct {
+    int gauge;          // index into mag_db.gauge
+    int strands;
+    double copper;      // bare copper area (mm^2)
+    double area;        // area taken in the window (mm^2)
+} mag_wire;
+
+typedef struct {
+    mag_core core[MAG_MAX_CORES];       // sorted by volume, smallest first
+    int cores;
+    char gauge[MAG_MAX_GAUGES][16];
+    int gauges;
+    mag_wire wire[MAG_MAX_GAUGES*MAG_MAX_STRANDS]; // sorted by window area
+    double best_copper[MAG_MAX_GAUGES*MAG_MAX_STRANDS]; // most copper among wire[0..i]
+    int best_wire[MAG_MAX_GAUGES*MAG_MAX_STRANDS];
+    int wires;
+} mag_db;
+
+typedef enum {
+    mag_min_loss = 0,
+    mag_min_volume
+} mag_objective;
+
+typedef struct {
+    double j_max;       // current density limit (A/mm^2)
+    mag_objective objective;
+} mag_limits;
+
+//One inductor to wind, from a finished design
+typedef struct {
+    const char *name;   // "L", "L1" or "L2"
+    double L;           // H
+    double i_avg;       // A
+    double ripple;      // peak to peak (A)
+    double f_switch;    // Hz
+} mag_inductor;
+
+typedef struct {
+    int core;           // index into mag_db.core, -1 if nothing fits
+    int wire;           // index into mag_db.wire
+    int turns;
+    double L;           // wound inductance, above the target for fixed AL cores (H)
+    double gap;         // air gap (mm), 0 for fixed AL cores
+    double b_peak;      // T
+    double b_ac;        // half the flux swing (T)
+    double p_core;      // W
+    double p_copper;    // W, DC resistance only
+    double p_total;
+    double volume;      // Ae*le (mm^3)
+    double fill;        // copper window fill
+} mag_choice;
+
+typedef struct {
+    long cores_pruned;  // skipped by the bound before trying any turns
+    long cores_tried;
+    long turns_tried;
+} mag_stats;
+
+void magnetics_design(void);
+int  mag_load_db(const char *path, mag_db *db);
+int  mag_inductors(const converter_input *input, const converter_result *result, mag_inductor *inductor);
+int  mag_search(const mag_db *db, const mag_limits *limits, const mag_inductor *inductor, mag_choice *choice, mag_stats *stats);
+size_t mag_search_batch(const mag_db *db, const mag_limits *limits, const mag_inductor *inductor,
+                        mag_choice *choice, size_t n, int threads);
+void mag_wire_name(const mag_db *db, int wire, char *name, size_t size);
+
+#endif
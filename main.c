@@ -7,6 +7,13 @@
 #include <ctype.h>
 #include <math.h>
 #include "funcs.h"
+#include "profile.h"
+#include "loss.h"
+#include "precision.h"
+#include "sweep.h"
+#include "tweak.h"
+#include "archive.h"
+#include "magnetics.h"
 
 /* Prototypes mirroring the C++ version */
 static void main_menu(void);            /* runs in the main loop */
@@ -14,10 +21,15 @@ static void print_main_menu(void);      /* output the main menu description */
 static int  get_user_input(void);       /* get a valid integer menu choice */
 static void select_menu_item(int input);/* run code based on user's choice */
 static void go_back_to_main(void);      /* wait for 'b'/'B' to continue */
+static void flush_input_line(void);     /* drop the rest of the line scanf() left behind */
 static int  is_integer(const char *s);  /* validate integer string */
 
-int main(void) 
+int main(int argc, char **argv) 
 {
+    /* batch sweeps run from the command line, everything else is the menu */
+    if (argc > 1 && (strcmp(argv[1], "sweep") == 0 || strcmp(argv[1], "merge") == 0)) {
+        return sweep_main(argc, argv);
+    }
     /* this will run forever until we call exit(0) in select_menu_item() */
     for(;;) {
         main_menu();
@@ -37,7 +49,7 @@ static void main_menu(void)
 
 static int get_user_input(void)
 {
-    enum { MENU_ITEMS = 5 };   /* 1..4 = items, 5 = Exit */
+    enum { MENU_ITEMS = 10 };  /* 1..10 = items, 0 = Exit */
     char buf[128];
     int valid_input = 0;
     int value = 0;
@@ -58,7 +70,7 @@ static int get_user_input(void)
             valid_input = 0;
         } else {
             value = (int)strtol(buf, NULL, 10);
-            if (value >= 1 && value <= MENU_ITEMS) {
+            if (value >= 0 && value <= MENU_ITEMS) {
                 valid_input = 1;
             } else {
                 printf("Invalid menu item!\n");
@@ -73,36 +85,42 @@ static int get_user_input(void)
 static void select_menu_item(int input)
 {
     switch (input) {
+        case 0:
+            printf("Bye!\n");
+            exit(0);
         case 1:
             buck_converter();
-            //After the scanf(), \n still remains and will be put into fgets, make two go_back_to_main. 
-            //Use a while loop to read that and empty the buffer.
-            int flush_buck;
-            while ((flush_buck = getchar()) != '\n' && flush_buck != EOF) {}
-            go_back_to_main();
             break;
         case 2:
             boost_converter();
-            int flush_boost;
-            while ((flush_boost = getchar()) != '\n' && flush_boost != EOF) {}
-            go_back_to_main();
             break;
         case 3:
             buck_boost_converter();
-            int flush_buck_boost;
-            while ((flush_buck_boost = getchar()) != '\n' && flush_buck_boost != EOF) {}
-            go_back_to_main();
             break;
         case 4:
             cuk_converter();
-            int flush_cuk;
-            while ((flush_cuk = getchar()) != '\n' && flush_cuk != EOF) {}
-            go_back_to_main();
             break;
-        default:
-            printf("Bye!\n");
-            exit(0);
+        case 5:
+            load_profile();
+            break;
+        case 6:
+            efficiency_map();
+            break;
+        case 7:
+            precision_audit_menu();
+            break;
+        case 8:
+            tweak_design();
+            break;
+        case 9:
+            design_archive();
+            break;
+        case 10:
+            magnetics_design();
+            break;
     }
+    flush_input_line();
+    go_back_to_main();
 }
 
 static void print_main_menu(void)
@@ -113,10 +131,24 @@ static void print_main_menu(void)
            "\t2. Boost Converter\n"
            "\t3. Buck Boost Converter\n"
            "\t4. Cuk Converter\n"
-           "\t5. Exit\n\n");
+           "\t5. Load Profile\n"
+           "\t6. Efficiency Map\n"
+           "\t7. Precision Audit\n"
+           "\t8. Tweak Design\n"
+           "\t9. Design Archive\n"
+           "\t10. Magnetics Design\n"
+           "\t0. Exit\n\n");
     printf("---------------------------------\n");
 }
 
+//After the scanf(), \n still remains and would be read by the fgets() in go_back_to_main.
+//Read that and empty the buffer.
+static void flush_input_line(void)
+{
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
 static void go_back_to_main(void)
 {
     char buf[64];
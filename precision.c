@@ -0,0 +1,508 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <string.h>
+#include "precision.h"
+#include "converter_eq.h"
+//Reduced precision versions of the topology calculators.
+//float32 is for screening sweeps, Q16.16 fixed-point is the MCU version. Both are checked against
+//the double calculators by an audit before they are trusted.
+
+#define PRECISION_BENCH_DESIGNS 1000000  // designs timed per precision
+#define PRECISION_BENCH_BLOCK 4096       // designs reused for them, small enough to stay in cache
+
+typedef int32_t q16;
+#define Q16_ONE (1 << 16)
+
+static void float_calculate(const converter_input *input, converter_result *result);
+static void float_block_buck(precision_float_block *b);
+static void float_block_boost(precision_float_block *b);
+static void float_block_buck_boost(precision_float_block *b);
+static void float_block_cuk(precision_float_block *b);
+static void fixed_calculate(const converter_input *input, converter_result *result);
+static double relative_error(double value, double reference);
+static double precision_bench(precision_mode mode, const converter_input *input, converter_result *result, int n, int rounds);
+static double precision_bench_batch(const converter_input *input, int n);
+
+void precision_audit_menu(void) {
+    converter_input input = {0};
+    converter_result result = {0};
+    precision_report report;
+    char mode_answer;
+    double tolerance = 0;
+
+    printf("\n>> Precision Audit\n");
+    if (!converter_read_design(&input, &result)) {
+        return;
+    }
+    printf("Precision (f = float32, x = fixed-point): ");
+    if (scanf(" %c", &mode_answer) != 1) {
+        return;
+    }
+    printf("Enter tolerance (%% relative error): ");
+    if (scanf("%lf", &tolerance) != 1 || !(tolerance > 0)) {
+        printf("ERROR: Tolerance must be > 0!\n");
+        return;
+    }
+
+    converter_input *samples = malloc(PRECISION_AUDIT_SAMPLES*sizeof(converter_input));
+    converter_result *results = malloc(PRECISION_BENCH_BLOCK*sizeof(converter_result));
+    if (!samples || !results) {
+        printf("ERROR: Not enough memory for the audit!\n");
+        free(samples);
+        free(results);
+        return;
+    }
+    //the run is every design within +-50 % of the one entered
+    uint64_t seed = 1;
+    for (int i = 0; i < PRECISION_AUDIT_SAMPLES; i++) {
+        precision_random_input(&input, 0.5, &seed, &samples[i]);
+    }
+
+    precision_mode requested = prec_float;
+    if (mode_answer == 'x' || mode_answer == 'X') {requested = prec_fixed;}
+    precision_audit(requested, samples, PRECISION_AUDIT_SAMPLES, &report);
+
+    printf("\n========== PRECISION AUDIT (%s) ==========\n", precision_name(requested));
+    printf("Samples                               = %d\n", report.samples);
+    if (input.type == cuk_conv) {
+        printf("Max error L1, L2                      = %.3e %%\n", report.max_err_L*100.0);
+        printf("Max error Co                          = %.3e %%\n", report.max_err_Co*100.0);
+        printf("Max error Cn                          = %.3e %%\n", report.max_err_Cn*100.0);
+    }
+    else {
+        printf("Max error L                           = %.3e %%\n", report.max_err_L*100.0);
+        printf("Max error C                           = %.3e %%\n", report.max_err_C*100.0);
+    }
+
+    precision_mode selected = precision_select(requested, samples, PRECISION_AUDIT_SAMPLES, tolerance/100.0, &report);
+    if (selected == requested) {
+        printf("Within tolerance, %s is safe for designs like this one\n", precision_name(selected));
+    }
+    else {
+        printf("Outside tolerance, designs like this one need %s\n", precision_name(selected));
+    }
+    //nothing is stored: the design menus always run double, sweeps take the precision from their spec
+    printf("Advisory only, the design menus stay in double. Use \"precision = %s\" in a sweep spec.\n",
+           selected == prec_fixed ? "fixed" : selected == prec_float ? "float" : "double");
+
+    char label[64];
+    snprintf(label, sizeof(label), "Time per design (%s)", precision_name(requested));
+    int rounds = PRECISION_BENCH_DESIGNS/PRECISION_BENCH_BLOCK;
+    printf("%-38s= %.2f ns\n", "Time per design (double)",
+           precision_bench(prec_double, samples, results, PRECISION_BENCH_BLOCK, rounds));
+    printf("%-38s= %.2f ns\n", label,
+           precision_bench(requested, samples, results, PRECISION_BENCH_BLOCK, rounds));
+    if (requested == prec_float) {
+        printf("%-38s= %.2f ns\n", "Time per design (float32 SoA batch)",
+               precision_bench_batch(samples, PRECISION_BENCH_DESIGNS));
+    }
+    free(samples);
+    free(results);
+}
+
+const char *precision_name(precision_mode mode) {
+    switch (mode) {
+        case prec_float: return "float32";
+        case prec_fixed: return "fixed-point";
+        default:         return "double";
+    }
+}
+
+//Run n designs in the chosen precision. Results are always stored as double so callers do not change.
+//float32 stays scalar here: converting the double structs to and from a precision_float_block costs
+//more than the vector kernel saves.
+void precision_calculate(precision_mode mode, const converter_input *input, converter_result *result, int n) {
+    switch (mode) {
+        case prec_float:
+            for (int i = 0; i < n; i++) {float_calculate(&input[i], &result[i]);}
+            break;
+        case prec_fixed:
+            for (int i = 0; i < n; i++) {fixed_calculate(&input[i], &result[i]);}
+            break;
+        default:
+            for (int i = 0; i < n; i++) {converter_calculate(&input[i], &result[i]);}
+            break;
+    }
+}
+
+//Compare the first n designs of a run against the double calculators.
+void precision_audit(precision_mode mode, const converter_input *inputs, int n, precision_report *report) {
+    report->mode = mode;
+    report->samples = n;
+    report->max_err_L = 0;
+    report->max_err_C = 0;
+    report->max_err_Co = 0;
+    report->max_err_Cn = 0;
+    for (int i = 0; i < n; i++) {
+        converter_result reference = {0};
+        converter_result result = {0};
+        converter_calculate(&inputs[i], &reference);
+        precision_calculate(mode, &inputs[i], &result, 1);
+        if (inputs[i].type == cuk_conv) {
+            report->max_err_L = fmax(report->max_err_L, relative_error(result.L1, reference.L1));
+            report->max_err_L = fmax(report->max_err_L, relative_error(result.L2, reference.L2));
+            report->max_err_Co = fmax(report->max_err_Co, relative_error(result.Co, reference.Co));
+            report->max_err_Cn = fmax(report->max_err_Cn, relative_error(result.Cn, reference.Cn));
+        }
+        else {
+            report->max_err_L = fmax(report->max_err_L, relative_error(result.L, reference.L));
+            report->max_err_C = fmax(report->max_err_C, relative_error(result.C, reference.C));
+        }
+    }
+}
+
+double precision_report_max(const precision_report *report) {
+    return fmax(fmax(report->max_err_L, report->max_err_C), fmax(report->max_err_Co, report->max_err_Cn));
+}
+
+//Return the fastest precision, no faster than requested, whose audit over the run stays within tolerance.
+//fixed-point falls back to float32, float32 falls back to double.
+precision_mode precision_select(precision_mode requested, const converter_input *inputs, int n,
+                                double tolerance, precision_report *report) {
+    precision_mode mode = requested;
+    while (mode != prec_double) {
+        precision_audit(mode, inputs, n, report);
+        if (precision_report_max(report) <= tolerance) {
+            return mode;
+        }
+        if (mode == prec_fixed) {mode = prec_float;}
+        else {mode = prec_double;}
+    }
+    //double is the reference itself, nothing to audit
+    memset(report, 0, sizeof(*report));
+    report->mode = prec_double;
+    return prec_double;
+}
+
+//Random design within a factor (1 + spread) of center on every value, log-uniform,
+//kept valid for the topology. xorshift64 so the same seed gives the same designs.
+void precision_random_input(const converter_input *center, double spread, uint64_t *seed, converter_input *input) {
+    double *const fields[] = {
+        &input->vin_min, &input->vin_max, &input->v_out, &input->p_out, &input->f_switch,
+        &input->ripple_i_percent, &input->ripple_i_1_percent, &input->ripple_i_2_percent,
+        &input->ripple_v_percent, &input->ripple_v_cn_percent
+    };
+    double span = log(1.0 + spread);
+
+    *input = *center;
+    for (size_t i = 0; i < sizeof(fields)/sizeof(fields[0]); i++) {
+        uint64_t x = *seed ? *seed : 0x9e3779b97f4a7c15ULL;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        *seed = x;
+        double u = (x >> 11)*(1.0/9007199254740992.0);
+        *fields[i] *= exp(span*(2.0*u - 1.0));
+    }
+    if (input->vin_max < input->vin_min) {input->vin_max = input->vin_min;}
+    if (input->type == buck_conv && input->v_out >= input->vin_min) {input->v_out = 0.9*input->vin_min;}
+    if (input->type == boost_conv && input->v_out <= input->vin_max) {input->v_out = 1.1*input->vin_max;}
+    if (input->ripple_i_percent > 100) {input->ripple_i_percent = 100;}
+    if (input->ripple_i_1_percent > 100) {input->ripple_i_1_percent = 100;}
+    if (input->ripple_i_2_percent > 100) {input->ripple_i_2_percent = 100;}
+    if (input->ripple_v_percent > 100) {input->ripple_v_percent = 100;}
+    if (input->ripple_v_cn_percent > 100) {input->ripple_v_cn_percent = 100;}
+}
+
+static double relative_error(double value, double reference) {
+    if (reference == 0) {
+        return fabs(value);
+    }
+    return fabs(value - reference)/fabs(reference);
+}
+
+//The same n designs run rounds times, so the timing needs no more memory than one block
+static double precision_bench(precision_mode mode, const converter_input *input, converter_result *result, int n, int rounds) {
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < rounds; i++) {
+        precision_calculate(mode, input, result, n);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    return ((stop.tv_sec - start.tv_sec)*1e9 + (stop.tv_nsec - start.tv_nsec))/((double)n*rounds);
+}
+
+//Kernel time only: one block is filled from the first designs and run n/PRECISION_BLOCK times
+static double precision_bench_batch(const converter_input *input, int n) {
+    precision_float_block *block = malloc(sizeof(precision_float_block));
+    if (!block) {
+        return 0;
+    }
+    block->type = input[0].type;
+    block->n = PRECISION_BLOCK;
+    for (int i = 0; i < PRECISION_BLOCK; i++) {
+        const converter_input *in = &input[i];
+        block->vin_min[i] = (float)in->vin_min;
+        block->vin_max[i] = (float)in->vin_max;
+        block->v_out[i] = (float)in->v_out;
+        block->p_out[i] = (float)in->p_out;
+        block->f_switch[i] = (float)in->f_switch;
+        block->ripple_i[i] = (float)(in->type == cuk_conv ? in->ripple_i_1_percent : in->ripple_i_percent);
+        block->ripple_i_2[i] = (float)in->ripple_i_2_percent;
+        block->ripple_v[i] = (float)in->ripple_v_percent;
+        block->ripple_v_cn[i] = (float)in->ripple_v_cn_percent;
+    }
+    int batches = n/PRECISION_BLOCK;
+    struct timespec start, stop;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < batches; i++) {
+        precision_float_batch(block);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    free(block);
+    return ((stop.tv_sec - start.tv_sec)*1e9 + (stop.tv_nsec - start.tv_nsec))/((double)batches*PRECISION_BLOCK);
+}
+
+//float32 instantiation of the equations in converter_eq.h, the double calculators run the _d ones
+static void float_calculate(const converter_input *input, converter_result *result) {
+    float vin = (float)input->vin_min;
+    float vin_max = (float)input->vin_max;
+    float v_out = (float)input->v_out;
+    float p_out = (float)input->p_out;
+    float f = (float)input->f_switch;
+    float duty, r_load, i_out, ripple_i, ripple_v;
+    float duty_off;     // 1 - D as Vin/(Vin + Vout), 1.0f - duty cancels to nothing when Vout >> Vin
+
+    r_load = r_load_f(v_out, p_out);
+    switch (input->type) {
+        case buck_conv:
+            duty = buck_duty_f(vin, v_out);
+            i_out = buck_i_out_f(v_out, r_load);
+            ripple_i = buck_ripple_i_f((float)input->ripple_i_percent, i_out);
+            ripple_v = ripple_v_f((float)input->ripple_v_percent, v_out);
+            result->L = buck_l_f(vin_max, v_out, duty, f, ripple_i);
+            result->C = buck_c_f(ripple_i, f, ripple_v);
+            break;
+        case boost_conv:
+            duty = boost_duty_f(vin, v_out);
+            i_out = i_out_f(p_out, v_out);
+            ripple_i = boost_ripple_i_f((float)input->ripple_i_percent, p_out, vin);
+            ripple_v = ripple_v_f((float)input->ripple_v_percent, v_out);
+            result->L = boost_l_f(vin, duty, ripple_i, f);
+            result->C = boost_c_f(i_out, duty, f, ripple_v);
+            break;
+        case buck_boost_conv:
+            duty = buck_boost_duty_f(vin, v_out);
+            duty_off = vin/(vin + v_out);
+            i_out = i_out_f(p_out, v_out);
+            ripple_i = buck_boost_ripple_i_f((float)input->ripple_i_percent, i_out, duty_off);
+            ripple_v = ripple_v_f((float)input->ripple_v_percent, v_out);
+            result->L = buck_boost_l_f(vin, duty, f, ripple_i);
+            result->C = buck_boost_c_f(i_out, duty, ripple_v, f);
+            break;
+        default: {
+            duty = buck_boost_duty_f(vin, v_out);
+            duty_off = vin/(vin + v_out);
+            i_out = i_out_f(p_out, v_out);
+            float L2 = cuk_l2_f(v_out, duty_off, f, cuk_delta_il_2_f(i_out, (float)input->ripple_i_2_percent));
+            ripple_i = 0;
+            ripple_v = 0;
+            result->L1 = cuk_l1_f(vin, duty, f, cuk_delta_il_1_f(p_out, vin, (float)input->ripple_i_1_percent));
+            result->L2 = L2;
+            result->Co = cuk_co_f(v_out, duty_off, f, (float)input->ripple_v_percent, L2);
+            result->Cn = cuk_cn_f(i_out, duty_off, f, vin, (float)input->ripple_v_cn_percent);
+            break;
+        }
+    }
+    result->duty_cycle = duty;
+    result->r_load = r_load;
+    result->i_out = i_out;
+    result->ripple_i_L = ripple_i;
+    result->ripple_v_C = ripple_v;
+}
+
+//Lanes from block->n on repeat lane 0, so the loops always run the whole block and never divide by zero.
+void precision_float_batch(precision_float_block *block) {
+    if (block->n < 1) {
+        return;
+    }
+    for (int i = block->n; i < PRECISION_BLOCK; i++) {
+        block->vin_min[i] = block->vin_min[0];
+        block->vin_max[i] = block->vin_max[0];
+        block->v_out[i] = block->v_out[0];
+        block->p_out[i] = block->p_out[0];
+        block->f_switch[i] = block->f_switch[0];
+        block->ripple_i[i] = block->ripple_i[0];
+        block->ripple_i_2[i] = block->ripple_i_2[0];
+        block->ripple_v[i] = block->ripple_v[0];
+        block->ripple_v_cn[i] = block->ripple_v_cn[0];
+    }
+    switch (block->type) {
+        case buck_conv:       float_block_buck(block); break;
+        case boost_conv:      float_block_boost(block); break;
+        case buck_boost_conv: float_block_buck_boost(block); break;
+        default:              float_block_cuk(block); break;
+    }
+}
+
+//Same equation calls as float_calculate, so each lane rounds the same way
+static void float_block_buck(precision_float_block *b) {
+    for (int i = 0; i < PRECISION_BLOCK; i++) {
+        float r_load = r_load_f(b->v_out[i], b->p_out[i]);
+        float duty = buck_duty_f(b->vin_min[i], b->v_out[i]);
+        float i_out = buck_i_out_f(b->v_out[i], r_load);
+        float ripple_i = buck_ripple_i_f(b->ripple_i[i], i_out);
+        float ripple_v = ripple_v_f(b->ripple_v[i], b->v_out[i]);
+        b->L[i] = buck_l_f(b->vin_max[i], b->v_out[i], duty, b->f_switch[i], ripple_i);
+        b->C[i] = buck_c_f(ripple_i, b->f_switch[i], ripple_v);
+        b->duty[i] = duty;
+        b->r_load[i] = r_load;
+        b->i_out[i] = i_out;
+        b->ripple_i_L[i] = ripple_i;
+        b->ripple_v_C[i] = ripple_v;
+    }
+}
+
+static void float_block_boost(precision_float_block *b) {
+    for (int i = 0; i < PRECISION_BLOCK; i++) {
+        float r_load = r_load_f(b->v_out[i], b->p_out[i]);
+        float duty = boost_duty_f(b->vin_min[i], b->v_out[i]);
+        float i_out = i_out_f(b->p_out[i], b->v_out[i]);
+        float ripple_i = boost_ripple_i_f(b->ripple_i[i], b->p_out[i], b->vin_min[i]);
+        float ripple_v = ripple_v_f(b->ripple_v[i], b->v_out[i]);
+        b->L[i] = boost_l_f(b->vin_min[i], duty, ripple_i, b->f_switch[i]);
+        b->C[i] = boost_c_f(i_out, duty, b->f_switch[i], ripple_v);
+        b->duty[i] = duty;
+        b->r_load[i] = r_load;
+        b->i_out[i] = i_out;
+        b->ripple_i_L[i] = ripple_i;
+        b->ripple_v_C[i] = ripple_v;
+    }
+}
+
+static void float_block_buck_boost(precision_float_block *b) {
+    for (int i = 0; i < PRECISION_BLOCK; i++) {
+        float r_load = r_load_f(b->v_out[i], b->p_out[i]);
+        float duty = buck_boost_duty_f(b->vin_min[i], b->v_out[i]);
+        float duty_off = b->vin_min[i]/(b->vin_min[i] + b->v_out[i]);
+        float i_out = i_out_f(b->p_out[i], b->v_out[i]);
+        float ripple_i = buck_boost_ripple_i_f(b->ripple_i[i], i_out, duty_off);
+        float ripple_v = ripple_v_f(b->ripple_v[i], b->v_out[i]);
+        b->L[i] = buck_boost_l_f(b->vin_min[i], duty, b->f_switch[i], ripple_i);
+        b->C[i] = buck_boost_c_f(i_out, duty, ripple_v, b->f_switch[i]);
+        b->duty[i] = duty;
+        b->r_load[i] = r_load;
+        b->i_out[i] = i_out;
+        b->ripple_i_L[i] = ripple_i;
+        b->ripple_v_C[i] = ripple_v;
+    }
+}
+
+static void float_block_cuk(precision_float_block *b) {
+    for (int i = 0; i < PRECISION_BLOCK; i++) {
+        float vin = b->vin_min[i];
+        float v_out = b->v_out[i];
+        float f = b->f_switch[i];
+        float duty = buck_boost_duty_f(vin, v_out);
+        float duty_off = vin/(vin + v_out);
+        float i_out = i_out_f(b->p_out[i], v_out);
+        float L2 = cuk_l2_f(v_out, duty_off, f, cuk_delta_il_2_f(i_out, b->ripple_i_2[i]));
+        b->L[i] = cuk_l1_f(vin, duty, f, cuk_delta_il_1_f(b->p_out[i], vin, b->ripple_i[i]));
+        b->L2[i] = L2;
+        b->C[i] = cuk_co_f(v_out, duty_off, f, b->ripple_v[i], L2);
+        b->Cn[i] = cuk_cn_f(i_out, duty_off, f, vin, b->ripple_v_cn[i]);
+        b->duty[i] = duty;
+        b->r_load[i] = r_load_f(v_out, b->p_out[i]);
+        b->i_out[i] = i_out;
+        b->ripple_i_L[i] = 0;
+        b->ripple_v_C[i] = 0;
+    }
+}
+
+//Q16.16 helpers, saturating so an overflow shows up as an audit error rather than a wrap
+static q16 q16_sat(int64_t x) {
+    if (x > INT32_MAX) {return INT32_MAX;}
+    if (x < INT32_MIN) {return INT32_MIN;}
+    return (q16)x;
+}
+
+static q16 q16_from(double x) {
+    x *= Q16_ONE;
+    if (x > INT32_MAX) {return INT32_MAX;}
+    if (x < INT32_MIN) {return INT32_MIN;}
+    return (q16)lround(x);
+}
+
+static double q16_to(q16 x) {
+    return x/(double)Q16_ONE;
+}
+
+static q16 q16_mul(q16 a, q16 b) {
+    return q16_sat(((int64_t)a*b) >> 16);
+}
+
+static q16 q16_div(q16 a, q16 b) {
+    if (b == 0) {return a >= 0 ? INT32_MAX : INT32_MIN;}
+    return q16_sat(((int64_t)a*Q16_ONE)/b);
+}
+
+//a*b/c with a 64-bit intermediate, so the product cannot overflow before the divide
+static q16 q16_muldiv(q16 a, q16 b, q16 c) {
+    if (c == 0) {return a >= 0 ? INT32_MAX : INT32_MIN;}
+    return q16_sat(((int64_t)a*b)/c);
+}
+
+//Fixed-point: quantities in V, A, W, kHz, uH and uF so typical designs fit in Q16.16 (max 32767).
+//Equations are ordered to keep intermediates near 1 and are otherwise those of *_calculate.
+static void fixed_calculate(const converter_input *input, converter_result *result) {
+    const q16 one = Q16_ONE;
+    const q16 k1000 = q16_from(1000.0);
+    q16 vin = q16_from(input->vin_min);
+    q16 vin_max = q16_from(input->vin_max);
+    q16 v_out = q16_from(input->v_out);
+    q16 p_out = q16_from(input->p_out);
+    q16 f_khz = q16_from(input->f_switch/1000.0);
+    q16 ripple_i = q16_from(input->ripple_i_percent/100.0);
+    q16 ripple_v = q16_mul(q16_from(input->ripple_v_percent/100.0), v_out);
+    q16 r_load = q16_muldiv(v_out, v_out, p_out);
+    q16 i_out = q16_div(p_out, v_out);
+    q16 duty, duty_off, delta_IL;
+
+    result->ripple_v_C = input->type == cuk_conv ? 0 : q16_to(ripple_v);
+    switch (input->type) {
+        case buck_conv:
+            duty = q16_div(v_out, vin);
+            delta_IL = q16_mul(ripple_i, i_out);
+            result->L = q16_to(q16_muldiv(q16_muldiv(vin_max - v_out, duty, delta_IL), k1000, f_khz))*1e-6;
+            result->C = q16_to(q16_muldiv(q16_div(delta_IL, ripple_v), q16_from(125.0), f_khz))*1e-6;
+            break;
+        case boost_conv:
+            duty = one - q16_div(vin, v_out);
+            delta_IL = q16_mul(ripple_i, q16_div(p_out, vin));
+            result->L = q16_to(q16_muldiv(q16_muldiv(vin, duty, delta_IL), k1000, f_khz))*1e-6;
+            result->C = q16_to(q16_muldiv(q16_muldiv(i_out, duty, ripple_v), k1000, f_khz))*1e-6;
+            break;
+        case buck_boost_conv:
+            duty = q16_div(v_out, vin + v_out);
+            duty_off = q16_div(vin, vin + v_out);   // 1 - D, as for float32
+            delta_IL = q16_mul(ripple_i, q16_div(i_out, duty_off));
+            result->L = q16_to(q16_muldiv(q16_muldiv(vin, duty, delta_IL), k1000, f_khz))*1e-6;
+            result->C = q16_to(q16_muldiv(q16_muldiv(i_out, duty, ripple_v), k1000, f_khz))*1e-6;
+            break;
+        default: {
+            duty = q16_div(v_out, vin + v_out);
+            duty_off = q16_div(vin, vin + v_out);
+            q16 delta_IL_1 = q16_mul(q16_div(p_out, vin), q16_from(input->ripple_i_1_percent/100.0));
+            q16 delta_IL_2 = q16_mul(i_out, q16_from(input->ripple_i_2_percent/100.0));
+            q16 delta_v_cn = q16_mul(vin, q16_from(input->ripple_v_cn_percent/100.0));
+            q16 L2_uH = q16_muldiv(q16_muldiv(v_out, duty_off, delta_IL_2), k1000, f_khz);
+            //Co = Vout(1-D)/(8 f^2 dVout L2), with f in kHz and L2 in uH the factor is 1e6/8/1e6
+            q16 co = q16_muldiv(v_out, duty_off, ripple_v);
+            co = q16_muldiv(co, k1000, f_khz);
+            co = q16_muldiv(co, k1000, f_khz);
+            co = q16_muldiv(co, q16_from(0.125), L2_uH);
+            delta_IL = 0;
+            result->L1 = q16_to(q16_muldiv(q16_muldiv(vin, duty, delta_IL_1), k1000, f_khz))*1e-6;
+            result->L2 = q16_to(L2_uH)*1e-6;
+            result->Co = q16_to(co)*1e-6;
+            result->Cn = q16_to(q16_muldiv(q16_muldiv(i_out, duty_off, delta_v_cn), k1000, f_khz))*1e-6;
+            break;
+        }
+    }
+    result->duty_cycle = q16_to(duty);
+    result->r_load = q16_to(r_load);
+    result->i_out = q16_to(i_out);
+    result->ripple_i_L = q16_to(delta_IL);
+}
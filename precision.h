@@ -0,0 +1,62 @@
+#ifndef PRECISION_H
+#define PRECISION_H
+
+#include <stdint.h>
+#include "funcs.h"
+
+#define PRECISION_AUDIT_SAMPLES 10000
+#define PRECISION_BLOCK 256  // designs per float32 batch, a multiple of every vector width
+
+typedef enum {
+    prec_double = 0,  // reference *_calculate
+    prec_float,       // float32 arithmetic
+    prec_fixed        // Q16.16 arithmetic in V, A, W, kHz, uH and uF
+} precision_mode;
+
+//Max relative error against the double-precision calculators
+typedef struct {
+    precision_mode mode;
+    int samples;
+    double max_err_L;   // L, or worst of L1 and L2 for cuk
+    double max_err_C;
+    double max_err_Co;
+    double max_err_Cn;
+} precision_report;
+
+//float32 batch of one topology as a structure of arrays. Fill type, n and the first n lanes of the
+//inputs, precision_float_batch sets the outputs of those lanes with the same bits as prec_float.
+//The block size is a compile time constant so -O2 vectorises every equation without a scalar tail.
+typedef struct {
+    converter_type type;
+    int n;                               // lanes in use, 1..PRECISION_BLOCK
+    float vin_min[PRECISION_BLOCK];
+    float vin_max[PRECISION_BLOCK];
+    float v_out[PRECISION_BLOCK];
+    float p_out[PRECISION_BLOCK];
+    float f_switch[PRECISION_BLOCK];
+    float ripple_i[PRECISION_BLOCK];     // ripple_i_1_percent for cuk
+    float ripple_i_2[PRECISION_BLOCK];   // cuk only
+    float ripple_v[PRECISION_BLOCK];
+    float ripple_v_cn[PRECISION_BLOCK];  // cuk only
+    float duty[PRECISION_BLOCK];
+    float r_load[PRECISION_BLOCK];
+    float i_out[PRECISION_BLOCK];
+    float ripple_i_L[PRECISION_BLOCK];
+    float ripple_v_C[PRECISION_BLOCK];
+    float L[PRECISION_BLOCK];            // L1 for cuk
+    float C[PRECISION_BLOCK];            // Co for cuk
+    float L2[PRECISION_BLOCK];           // cuk only
+    float Cn[PRECISION_BLOCK];           // cuk only
+} precision_float_block;
+
+void precision_audit_menu(void);
+void precision_calculate(precision_mode mode, const converter_input *input, converter_result *result, int n);
+void precision_float_batch(precision_float_block *block);
+void precision_random_input(const converter_input *center, double spread, uint64_t *seed, converter_input *input);
+void precision_audit(precision_mode mode, const converter_input *inputs, int n, precision_report *report);
+double precision_report_max(const precision_report *report);
+precision_mode precision_select(precision_mode requested, const converter_input *inputs, int n,
+                                double tolerance, precision_report *report);
+const char *precision_name(precision_mode mode);
+
+#endif
@@ -0,0 +1,372 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <math.h>
+#include "profile.h"
+//Streams a load profile (output power over time) through a finished design.
+//Only one chunk of samples is held at a time, so a log of any length runs in constant memory.
+
+#define PROFILE_TEXT_BUF (1 << 16)
+
+typedef struct {
+    FILE *src;
+    profile_format format;
+    char text[PROFILE_TEXT_BUF];
+    size_t len;
+    size_t pos;
+    int eof;
+    int skipping;    // in a line longer than the buffer, dropped up to its newline
+    long rejected;   // NaN or infinite samples dropped
+    long skipped;    // lines dropped for their length
+    long trailing;   // bytes of a partial binary sample at the end
+} profile_reader;
+
+static int  profile_read_chunk(profile_reader *reader, double *p_out, int max);
+static int  profile_read_csv(profile_reader *reader, double *p_out, int max);
+static void profile_accumulate(profile_summary *sum, const double *p_out, const double *duty,
+                               const double *i_peak, const unsigned char *flags, int n);
+static void profile_merge(profile_summary *total, const profile_summary *sum);
+static void profile_write_interval(FILE *out, long index, double dt, long start, const profile_summary *sum);
+
+void load_profile(void) {
+    converter_input input = {0};
+    converter_result result = {0};
+    profile_model model;
+    profile_summary total;
+    char file_name[256];
+    char format_answer;
+    double dt = 0;
+    double interval = 0;
+
+    printf("\n>> Load Profile\n");
+    if (!converter_read_design(&input, &result)) {
+        return;
+    }
+    printf("Enter profile file name: ");
+    if (scanf("%255s", file_name) != 1) {
+        return;
+    }
+    printf("File format (c = CSV, b = binary double): ");
+    if (scanf(" %c", &format_answer) != 1) {
+        return;
+    }
+    printf("Enter sample period (s): ");
+    if (scanf("%lf", &dt) != 1 || !isfinite(dt) || dt <= 0) {
+        printf("ERROR: Sample period must be a number > 0!\n");
+        return;
+    }
+    printf("Enter summary interval (s): ");
+    if (scanf("%lf", &interval) != 1 || !isfinite(interval) || interval < dt || interval/dt > LONG_MAX/2) {
+        printf("ERROR: Interval must be a number >= sample period!\n");
+        return;
+    }
+
+    profile_format format = profile_csv;
+    if (format_answer == 'b' || format_answer == 'B') {format = profile_binary;}
+    FILE *src = fopen(file_name, format == profile_binary ? "rb" : "r");
+    if (!src) {perror("fopen");
+        return;
+    }
+    FILE *out = fopen("profile_results.txt", "w");
+    if (!out) {perror("fopen");
+        fclose(src);
+        return;
+    }
+
+    profile_build_model(&input, &result, &model);
+    long interval_samples = (long)(interval/dt + 0.5);
+    long samples = profile_run(src, format, &model, dt, interval_samples, out, &total);
+    fclose(src);
+    fclose(out);
+    if (samples < 0) {
+        printf("ERROR: Out of memory!\n");
+        return;
+    }
+
+    printf("\n========== LOAD PROFILE SUMMARY ==========\n");
+    printf("Samples                               = %ld\n", total.samples);
+    printf("Duration                              = %.3f s\n", total.samples*dt);
+    if (total.rejected_samples > 0) {
+        printf("Rejected samples (NaN or infinite)    = %ld\n", total.rejected_samples);
+    }
+    printf("Time in DCM                           = %.3f s\n", total.dcm_samples*dt);
+    if (!model.dcm_modelled && total.dcm_samples > 0) {
+        printf("  DCM duty and IL peak not modelled for Cuk, CCM values used\n");
+    }
+    printf("Time with inductor ripple > 40%%       = %.3f s\n", total.ripple_i_samples*dt);
+    printf("Time with voltage ripple > 5%%         = %.3f s\n", total.ripple_v_samples*dt);
+    printf("Maximum output power                  = %.2f W\n", total.max_p_out);
+    printf("Maximum inductor peak      (IL peak)  = %.3f A\n", total.max_i_L_peak);
+    printf("Duty cycle histogram:\n");
+    for (int i = 0; i < PROFILE_DUTY_BINS; i++) {
+        printf("  %.1f - %.1f : %ld\n", i/(double)PROFILE_DUTY_BINS, (i + 1)/(double)PROFILE_DUTY_BINS, total.duty_hist[i]);
+    }
+    printf("Interval summary saved to profile_results.txt\n");
+    if (total.skipped_lines > 0) {
+        printf("WARNING: %ld lines longer than %d characters were skipped\n", total.skipped_lines, PROFILE_TEXT_BUF - 1);
+    }
+    if (total.trailing_bytes > 0) {
+        printf("WARNING: The file ends with %ld bytes that are not a whole sample, it may be truncated\n", total.trailing_bytes);
+    }
+    if (total.read_error) {
+        printf("ERROR: Reading %s failed, the summary stops at the last sample read\n", file_name);
+    }
+}
+
+//Reduce the design to the few constants the per-sample equations need.
+//With L fixed the ripple does not change with load, so the boundary current i_LB stays the same
+//and only the average inductor current moves with output power.
+void profile_build_model(const converter_input *input, const converter_result *result, profile_model *model) {
+    double ripple_i = input->type == cuk_conv ? fmax(input->ripple_i_1_percent, input->ripple_i_2_percent)
+                                              : input->ripple_i_percent;
+    model->i_LB = result->i_LB;
+    //ripple in % of the average current goes as 1/load, for each inductor of cuk on its own
+    model->ripple_i_watts = ripple_i*input->p_out;
+    model->duty_ccm = result->duty_cycle;
+    model->ripple_v_const = 0;
+    model->ripple_v_per_watt = 0;
+    model->dcm_modelled = 1;
+    switch (input->type) {
+        case buck_conv:
+            //IL = Iout, output ripple only depends on delta IL
+            model->amps_per_watt = 1.0/input->v_out;
+            model->ripple_v_const = input->ripple_v_percent;
+            break;
+        case boost_conv:
+            //IL = Iin, output ripple is Iout*D/(f*C)
+            model->amps_per_watt = 1.0/input->vin_min;
+            model->ripple_v_per_watt = input->ripple_v_percent/input->p_out;
+            break;
+        case buck_boost_conv:
+            model->amps_per_watt = 1.0/(input->v_out*(1.0 - result->duty_cycle));
+            model->ripple_v_per_watt = input->ripple_v_percent/input->p_out;
+            break;
+        case cuk_conv:
+            //worst of IL1 and IL2, same as cuk_analyse
+            model->amps_per_watt = fmax(1.0/input->vin_min, 1.0/input->v_out);
+            model->ripple_v_const = input->ripple_v_percent;
+            //IL/ILB = (D/D_ccm)^2 does not hold with two inductors, DCM is detected but not modelled
+            model->dcm_modelled = 0;
+            break;
+    }
+}
+
+//The design() input of the same converter at another load: L and C stay, so the ripple currents stay
+//and their percentages scale with 1/load, as do the voltage ripples that follow Iout. For checking the model.
+void profile_input_at(const converter_input *rated, double p_out, converter_input *input) {
+    double scale = rated->p_out/p_out;
+    *input = *rated;
+    input->p_out = p_out;
+    input->ripple_i_percent *= scale;
+    input->ripple_i_1_percent *= scale;
+    input->ripple_i_2_percent *= scale;
+    input->ripple_v_cn_percent /= scale;
+    if (rated->type == boost_conv || rated->type == buck_boost_conv) {
+        input->ripple_v_percent /= scale;
+    }
+}
+
+//Stream every sample from src, write one summary line per interval to out and the totals to total.
+//Return the number of samples evaluated, or -1 if out of memory.
+//NaN and infinite samples are dropped and counted in total->rejected_samples.
+long profile_run(FILE *src, profile_format format, const profile_model *model,
+                 double dt, long interval_samples, FILE *out, profile_summary *total) {
+    profile_reader *reader = malloc(sizeof(profile_reader));
+    double p_out[PROFILE_CHUNK];
+    double duty[PROFILE_CHUNK];
+    double i_peak[PROFILE_CHUNK];
+    unsigned char flags[PROFILE_CHUNK];
+    profile_summary sum;
+    long interval_index = 0;
+    long interval_start = 0;
+    int n;
+
+    memset(total, 0, sizeof(*total));
+    if (!reader) {
+        return -1;
+    }
+    memset(reader, 0, sizeof(*reader));
+    reader->src = src;
+    reader->format = format;
+    memset(&sum, 0, sizeof(sum));
+    if (interval_samples < 1) {interval_samples = 1;}
+
+    fprintf(out, "interval, t_start, samples, t_DCM, t_ripple_I, t_ripple_V, Pout_max, IL_peak_max");
+    for (int i = 0; i < PROFILE_DUTY_BINS; i++) {
+        fprintf(out, ", D_%.1f", i/(double)PROFILE_DUTY_BINS);
+    }
+    fprintf(out, "\n");
+
+    while ((n = profile_read_chunk(reader, p_out, PROFILE_CHUNK)) > 0) {
+        profile_eval_chunk(model, p_out, n, duty, i_peak, flags);
+        //a chunk can cross interval boundaries, so reduce it piece by piece
+        int first = 0;
+        while (first < n) {
+            long left = interval_samples - sum.samples;
+            int count = n - first;
+            if (count > left) {count = (int)left;}
+            profile_accumulate(&sum, p_out + first, duty + first, i_peak + first, flags + first, count);
+            first += count;
+            if (sum.samples == interval_samples) {
+                profile_write_interval(out, interval_index, dt, interval_start, &sum);
+                profile_merge(total, &sum);
+                interval_index++;
+                interval_start += sum.samples;
+                memset(&sum, 0, sizeof(sum));
+            }
+        }
+    }
+    if (sum.samples > 0) {
+        profile_write_interval(out, interval_index, dt, interval_start, &sum);
+        profile_merge(total, &sum);
+    }
+    total->rejected_samples = reader->rejected;
+    total->skipped_lines = reader->skipped;
+    total->trailing_bytes = reader->trailing;
+    total->read_error = ferror(src) != 0;
+    free(reader);
+    return total->samples;
+}
+
+//Return up to max finite samples, 0 at the end of the profile
+static int profile_read_chunk(profile_reader *reader, double *p_out, int max) {
+    int kept = 0;
+    while (kept == 0) {
+        int n;
+        if (reader->format == profile_binary) {
+            //bytes, so a partial sample at the end is seen rather than dropped by fread
+            size_t got = fread(p_out, 1, (size_t)max*sizeof(double), reader->src);
+            n = (int)(got/sizeof(double));
+            reader->trailing += (long)(got % sizeof(double));
+        }
+        else {
+            n = profile_read_csv(reader, p_out, max);
+        }
+        if (n == 0) {
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            if (isfinite(p_out[i])) {p_out[kept++] = p_out[i];}
+        }
+        reader->rejected += n - kept;
+    }
+    return kept;
+}
+
+//Parse up to max samples out of a large text buffer. Lines without a number (header, blank) are skipped.
+//A line longer than the buffer is dropped whole, up to its newline, and counted.
+static int profile_read_csv(profile_reader *reader, double *p_out, int max) {
+    int n = 0;
+    while (n < max) {
+        char *line = reader->text + reader->pos;
+        char *end = memchr(line, '\n', reader->len - reader->pos);
+        if (!end) {
+            if (!reader->eof) {
+                //move the partial line to the front and refill
+                size_t rest = reader->len - reader->pos;
+                if (rest >= PROFILE_TEXT_BUF - 1) {
+                    rest = 0;
+                    reader->skipping = 1;
+                }
+                memmove(reader->text, line, rest);
+                reader->len = rest;
+                reader->pos = 0;
+                size_t got = fread(reader->text + rest, 1, PROFILE_TEXT_BUF - 1 - rest, reader->src);
+                reader->len += got;
+                if (got == 0) {reader->eof = 1;}
+                reader->text[reader->len] = '\0';
+                continue;
+            }
+            if (reader->pos >= reader->len) {
+                if (reader->skipping) {
+                    reader->skipping = 0;
+                    reader->skipped++;
+                }
+                break;
+            }
+            end = reader->text + reader->len; // last line has no newline
+        }
+        *end = '\0';
+        reader->pos = (size_t)(end - reader->text) + 1;
+        if (reader->pos > reader->len) {reader->pos = reader->len;}
+        if (reader->skipping) {
+            //the tail of a line that was too long
+            reader->skipping = 0;
+            reader->skipped++;
+            continue;
+        }
+
+        char *field = strrchr(line, ',');
+        if (field) {field++;}
+        else {field = line;}
+        char *parsed;
+        double value = strtod(field, &parsed);
+        if (parsed != field) {
+            p_out[n++] = value;
+        }
+    }
+    return n;
+}
+
+//Branch-free per-sample equations so the compiler can vectorise the loop.
+//In DCM, IL/ILB = (D/D_ccm)^2 for buck, boost and buck-boost, and the peak is 2*sqrt(IL*ILB).
+//Cuk keeps the CCM duty and peak in DCM, see profile_build_model.
+void profile_eval_chunk(const profile_model *model, const double *p_out, int n,
+                        double *duty, double *i_peak, unsigned char *flags) {
+    double i_LB = model->i_LB;
+    int dcm_modelled = model->dcm_modelled;
+    for (int i = 0; i < n; i++) {
+        double p = p_out[i] > 0 ? p_out[i] : 0;
+        double i_L = model->amps_per_watt*p;
+        double root = sqrt(i_L/i_LB);
+        int ccm = i_L > i_LB;
+        int ccm_equations = ccm | !dcm_modelled;
+        duty[i] = ccm_equations ? model->duty_ccm : model->duty_ccm*root;
+        i_peak[i] = ccm_equations ? i_L + i_LB : 2.0*i_LB*root;
+        double ripple_v = model->ripple_v_const + model->ripple_v_per_watt*p;
+        flags[i] = (unsigned char)((!ccm)*profile_flag_dcm
+                 | (model->ripple_i_watts > 40.0*p)*profile_flag_ripple_i
+                 | (ripple_v > 5.0)*profile_flag_ripple_v);
+    }
+}
+
+static void profile_accumulate(profile_summary *sum, const double *p_out, const double *duty,
+                               const double *i_peak, const unsigned char *flags, int n) {
+    for (int i = 0; i < n; i++) {
+        sum->dcm_samples += (flags[i] & profile_flag_dcm) != 0;
+        sum->ripple_i_samples += (flags[i] & profile_flag_ripple_i) != 0;
+        sum->ripple_v_samples += (flags[i] & profile_flag_ripple_v) != 0;
+        if (p_out[i] > sum->max_p_out) {sum->max_p_out = p_out[i];}
+        if (i_peak[i] > sum->max_i_L_peak) {sum->max_i_L_peak = i_peak[i];}
+        //clamp before the conversion, out of range or NaN to int is undefined
+        double position = duty[i]*PROFILE_DUTY_BINS;
+        int bin = 0;
+        if (position >= PROFILE_DUTY_BINS) {bin = PROFILE_DUTY_BINS - 1;}
+        else if (position > 0) {bin = (int)position;}
+        sum->duty_hist[bin]++;
+    }
+    sum->samples += n;
+}
+
+static void profile_merge(profile_summary *total, const profile_summary *sum) {
+    total->samples += sum->samples;
+    total->dcm_samples += sum->dcm_samples;
+    total->ripple_i_samples += sum->ripple_i_samples;
+    total->ripple_v_samples += sum->ripple_v_samples;
+    if (sum->max_p_out > total->max_p_out) {total->max_p_out = sum->max_p_out;}
+    if (sum->max_i_L_peak > total->max_i_L_peak) {total->max_i_L_peak = sum->max_i_L_peak;}
+    for (int i = 0; i < PROFILE_DUTY_BINS; i++) {
+        total->duty_hist[i] += sum->duty_hist[i];
+    }
+}
+
+static void profile_write_interval(FILE *out, long index, double dt, long start, const profile_summary *sum) {
+    fprintf(out, "%ld, %.3f, %ld, %.3f, %.3f, %.3f, %.3f, %.3f", index, start*dt, sum->samples,
+            sum->dcm_samples*dt, sum->ripple_i_samples*dt, sum->ripple_v_samples*dt,
+            sum->max_p_out, sum->max_i_L_peak);
+    for (int i = 0; i < PROFILE_DUTY_BINS; i++) {
+        fprintf(out, ", %ld", sum->duty_hist[i]);
+    }
+    fprintf(out, "\n");
+}
@@ -0,0 +1,56 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include "funcs.h"
+
+#define PROFILE_CHUNK      4096  // samples evaluated per pass, memory stays constant
+#define PROFILE_DUTY_BINS  10    // duty histogram bins of 0.1 over 0..1
+
+typedef enum {
+    profile_csv = 0,    // one sample per line, power in the last column
+    profile_binary      // raw native-endian doubles of output power
+} profile_format;
+
+//Load model of a finished design, built once from converter_result
+typedef struct {
+    double amps_per_watt;     // average inductor current per watt of load
+    double i_LB;              // boundary current of the design
+    double duty_ccm;          // duty cycle while in CCM
+    double ripple_v_const;    // output voltage ripple in % that does not move with load
+    double ripple_v_per_watt; // output voltage ripple in % per watt of load
+    double ripple_i_watts;    // largest inductor ripple in % times rated power: over 40 % below ripple_i_watts/40 W
+    int    dcm_modelled;      // 0 for cuk, DCM is flagged but duty and peak keep the CCM values
+} profile_model;
+
+//Summary of one interval of the profile
+typedef struct {
+    long   samples;
+    long   dcm_samples;
+    long   ripple_i_samples;  // inductor ripple > 40 % of IL
+    long   ripple_v_samples;  // voltage ripple > 5 % of Vout
+    double max_p_out;
+    double max_i_L_peak;
+    long   duty_hist[PROFILE_DUTY_BINS];
+    long   rejected_samples;  // NaN or infinite, not evaluated (totals only)
+    long   skipped_lines;     // CSV lines longer than the read buffer, not evaluated (totals only)
+    long   trailing_bytes;    // binary file ends with part of a sample (totals only)
+    int    read_error;        // the file could not be read to the end (totals only)
+} profile_summary;
+
+//flags of one sample from profile_eval_chunk
+enum {
+    profile_flag_dcm      = 1,
+    profile_flag_ripple_i = 2,
+    profile_flag_ripple_v = 4
+};
+
+void load_profile(void);
+void profile_build_model(const converter_input *input, const converter_result *result, profile_model *model);
+void profile_input_at(const converter_input *rated, double p_out, converter_input *input);
+void profile_eval_chunk(const profile_model *model, const double *p_out, int n,
+                        double *duty, double *i_peak, unsigned char *flags);
+long profile_run(FILE *src, profile_format format, const profile_model *model,
+                 double dt, long interval_samples, FILE *out, profile_summary *total);
+
+#endif
@@ -0,0 +1,656 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/syscall.h>
+//Scripted session replay.
+//Each script is the keystrokes of one menu session, one answer per line. A session runs the program on a
+//pseudo terminal in lockstep: wait for a prompt, time it, type the next line. The output is compared byte
+//for byte with the golden transcript next to the script (buck.in -> buck.out), so a change in wording,
+//a result or the order of prompts shows up as the first line that differs.
+//Sessions run on --jobs threads, each thread keeps its own statistics and they are merged at the end.
+//
+//  replay.out [--pipe] [--record] [--sessions N] [--jobs J] [--timeout s] <program> <script.in>...
+//
+//--pipe feeds the whole script through a pipe instead, much faster but only the session time is known.
+//The transcript is the same either way: echo and output processing are off on the terminal.
+//--record runs each script once and writes its golden transcript.
+//Timings change from run to run, so a number followed by " ns", " us" or " ms" is written as "#" in the
+//golden transcript and compared that way.
+
+#define REPLAY_MAX_SCRIPTS  64
+#define REPLAY_MAX_PROMPTS  128
+#define REPLAY_PROMPT_TEXT  64
+#define REPLAY_CHUNK        4096
+
+extern char **environ;
+
+typedef struct {
+    char path[256];
+    char golden_path[256];
+    char *input;
+    size_t input_len;
+    char *golden;
+    size_t golden_len;
+} replay_script;
+
+//Growable list of latencies (ms)
+typedef struct {
+    double *ms;
+    size_t count;
+    size_t cap;
+} replay_samples;
+
+typedef struct {
+    char text[REPLAY_PROMPT_TEXT];   // last line of output before the program waited for input
+    replay_samples samples;
+} replay_prompt;
+
+typedef struct {
+    replay_prompt prompt[REPLAY_MAX_PROMPTS];
+    int prompts;
+    replay_samples session[REPLAY_MAX_SCRIPTS];
+    long mismatches;
+    long failures;                   // timed out, crashed or could not start
+    int first_script;                // first mismatching session, -1 if none
+    char *first_output;
+    size_t first_len;
+} replay_stats;
+
+//Transcript of one session
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} replay_output;
+
+typedef struct {
+    const char *program;
+    const replay_script *script;
+    int scripts;
+    long sessions;
+    int jobs;
+    int job;
+    int pipe_mode;
+    double timeout;
+    replay_stats stats;
+} replay_job;
+
+static double replay_now(void);
+static int    replay_read_file(const char *path, char **data, size_t *len);
+static void   replay_push(replay_samples *samples, double ms);
+static void   replay_append(replay_output *out, const char *data, size_t len);
+static size_t replay_mask_times(char *data, size_t len);
+static void   replay_prompt_sample(replay_stats *stats, const replay_output *out, size_t mark, int first, double ms);
+static int    replay_pty(const char *program, const replay_script *script, double timeout,
+                         replay_output *out, replay_stats *stats);
+static int    replay_pipe(const char *program, const replay_script *script, double timeout, replay_output *out);
+static pid_t  replay_spawn(const char *program, int in, int out);
+static int    replay_wait(pid_t pid, double deadline);
+static void  *replay_worker(void *arg);
+static void   replay_merge(replay_stats *into, replay_stats *from);
+static void   replay_report_samples(const char *name, replay_samples *samples);
+static void   replay_first_difference(const replay_script *script, const char *output, size_t len);
+static void   replay_usage(void);
+
+int main(int argc, char **argv) {
+    static replay_script script[REPLAY_MAX_SCRIPTS];
+    int scripts = 0;
+    int pipe_mode = 0;
+    int record = 0;
+    long sessions = 0;
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    double timeout = 10.0;
+    const char *program = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--pipe") == 0) {
+            pipe_mode = 1;
+        } else if (strcmp(argv[i], "--record") == 0) {
+            record = 1;
+        } else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+            sessions = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs = (int)strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeout = strtod(argv[++i], NULL);
+        } else if (argv[i][0] == '-') {
+            replay_usage();
+            return 1;
+        } else if (program == NULL) {
+            program = argv[i];
+        } else if (scripts < REPLAY_MAX_SCRIPTS) {
+            replay_script *s = &script[scripts++];
+            size_t n = strlen(argv[i]);
+            snprintf(s->path, sizeof(s->path), "%s", argv[i]);
+            //buck.in -> buck.out, anything else gets .out appended
+            if (n > 3 && strcmp(argv[i] + n - 3, ".in") == 0) {
+                snprintf(s->golden_path, sizeof(s->golden_path), "%.*s.out", (int)(n - 3), argv[i]);
+            } else {
+                snprintf(s->golden_path, sizeof(s->golden_path), "%s.out", argv[i]);
+            }
+            if (!replay_read_file(s->path, &s->input, &s->input_len)) {
+                printf("ERROR: cannot read script %s\n", s->path);
+                return 1;
+            }
+        } else {
+            printf("ERROR: more than %d scripts\n", REPLAY_MAX_SCRIPTS);
+            return 1;
+        }
+    }
+    if (program == NULL || scripts == 0 || jobs < 1 || timeout <= 0) {
+        replay_usage();
+        return 1;
+    }
+    if (sessions < scripts) {
+        sessions = scripts;
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    if (record) {
+        for (int s = 0; s < scripts; s++) {
+            replay_output out = {0};
+            int ok = pipe_mode ? replay_pipe(program, &script[s], timeout, &out)
+                               : replay_pty(program, &script[s], timeout, &out, NULL);
+            out.len = replay_mask_times(out.data, out.len);
+            FILE *fp = ok ? fopen(script[s].golden_path, "wb") : NULL;
+            if (fp == NULL || fwrite(out.data, 1, out.len, fp) != out.len) {
+                printf("ERROR: could not record %s\n", script[s].golden_path);
+                return 1;
+            }
+            fclose(fp);
+            printf("Recorded %s (%zu bytes)\n", script[s].golden_path, out.len);
+            free(out.data);
+        }
+        return 0;
+    }
+    for (int s = 0; s < scripts; s++) {
+        if (!replay_read_file(script[s].golden_path, &script[s].golden, &script[s].golden_len)) {
+            printf("ERROR: no golden transcript %s, run with --record first\n", script[s].golden_path);
+            return 1;
+        }
+        script[s].golden_len = replay_mask_times(script[s].golden, script[s].golden_len);
+    }
+
+    //Session i replays script i % scripts, job j takes sessions j, j + jobs, ...
+    if (jobs > sessions) {
+        jobs = (int)sessions;
+    }
+    replay_job *job = calloc((size_t)jobs, sizeof(*job));
+    pthread_t *thread = malloc((size_t)jobs*sizeof(*thread));
+    if (job == NULL || thread == NULL) {
+        printf("ERROR: out of memory\n");
+        return 1;
+    }
+    double start = replay_now();
+    for (int j = 0; j < jobs; j++) {
+        job[j].program = program;
+        job[j].script = script;
+        job[j].scripts = scripts;
+        job[j].sessions = sessions;
+        job[j].jobs = jobs;
+        job[j].job = j;
+        job[j].pipe_mode = pipe_mode;
+        job[j].timeout = timeout;
+        job[j].stats.first_script = -1;
+        pthread_create(&thread[j], NULL, replay_worker, &job[j]);
+    }
+    for (int j = 0; j < jobs; j++) {
+        pthread_join(thread[j], NULL);
+    }
+    double elapsed = replay_now() - start;
+    for (int j = 1; j < jobs; j++) {
+        replay_merge(&job[0].stats, &job[j].stats);
+    }
+    replay_stats *stats = &job[0].stats;
+
+    printf("Replayed %ld sessions of %d scripts in %.2f s (%.0f sessions/s, %d jobs, %s)\n",
+           sessions, scripts, elapsed, (double)sessions/elapsed, jobs, pipe_mode ? "pipe" : "pty");
+    printf("Mismatches: %ld, failures: %ld\n", stats->mismatches, stats->failures);
+    printf("\nSession latency (ms)%*s%8s %8s %8s %8s\n", 28, "", "count", "p50", "p99", "max");
+    for (int s = 0; s < scripts; s++) {
+        replay_report_samples(script[s].path, &stats->session[s]);
+    }
+    if (!pipe_mode) {
+        printf("\nPrompt latency (ms)%*s%8s %8s %8s %8s\n", 29, "", "count", "p50", "p99", "max");
+        for (int p = 0; p < stats->prompts; p++) {
+            replay_report_samples(stats->prompt[p].text, &stats->prompt[p].samples);
+        }
+    }
+    if (stats->first_script >= 0) {
+        replay_first_difference(&script[stats->first_script], stats->first_output, stats->first_len);
+    }
+    return (stats->mismatches == 0 && stats->failures == 0) ? 0 : 1;
+}
+
+static void *replay_worker(void *arg) {
+    replay_job *job = arg;
+    replay_output out = {0};
+
+    for (long i = job->job; i < job->sessions; i += job->jobs) {
+        int s = (int)(i % job->scripts);
+        const replay_script *script = &job->script[s];
+        out.len = 0;
+        double t0 = replay_now();
+        int ok = job->pipe_mode ? replay_pipe(job->program, script, job->timeout, &out)
+                                : replay_pty(job->program, script, job->timeout, &out, &job->stats);
+        replay_push(&job->stats.session[s], (replay_now() - t0)*1e3);
+        if (!ok) {
+            job->stats.failures++;
+        }
+        out.len = replay_mask_times(out.data, out.len);
+        if (out.len != script->golden_len || (out.len > 0 && memcmp(out.data, script->golden, out.len) != 0)) {
+            job->stats.mismatches++;
+            if (job->stats.first_script < 0) {
+                job->stats.first_script = s;
+                job->stats.first_output = malloc(out.len + 1);
+                if (job->stats.first_output != NULL) {
+                    memcpy(job->stats.first_output, out.data, out.len);
+                    job->stats.first_len = out.len;
+                }
+            }
+        }
+    }
+    free(out.data);
+    return NULL;
+}
+
+//Lockstep session on a pseudo terminal. The program flushes its line buffered stdout when it reads the
+//terminal, so output ending in ':' or ": " is a prompt and the program is now waiting for the next line.
+//Once the script runs out the terminal sends end of file, as closing the pipe would.
+static int replay_pty(const char *program, const replay_script *script, double timeout,
+                      replay_output *out, replay_stats *stats) {
+    struct termios tio;
+    char name[64];
+    char buf[REPLAY_CHUNK];
+
+    memset(&tio, 0, sizeof(tio));
+    tio.c_cflag = CS8 | CREAD | CLOCAL;
+    tio.c_lflag = ICANON;                // line editing for the program, but no echo
+    tio.c_cc[VEOF] = 4;
+    tio.c_cc[VMIN] = 1;
+    cfsetispeed(&tio, B38400);
+    cfsetospeed(&tio, B38400);
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0) {
+        return 0;
+    }
+    int slave = -1;
+    if (grantpt(master) == 0 && unlockpt(master) == 0 && ptsname_r(master, name, sizeof(name)) == 0) {
+        slave = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    }
+    if (slave < 0 || tcsetattr(slave, TCSANOW, &tio) != 0) {
+        if (slave >= 0) {
+            close(slave);
+        }
+        close(master);
+        return 0;
+    }
+    pid_t pid = replay_spawn(program, slave, slave);
+    close(slave);
+    if (pid < 0) {
+        close(master);
+        return 0;
+    }
+
+    const char *next = script->input;
+    const char *end = script->input + script->input_len;
+    double deadline = replay_now() + timeout;
+    double sent = replay_now();
+    size_t mark = 0;                     // transcript length when the last line was sent
+    int first = 1;
+    int ok = 1;
+
+    for (;;) {
+        struct pollfd pfd = {master, POLLIN, 0};
+        int wait_ms = (int)((deadline - replay_now())*1e3);
+        if (wait_ms <= 0 || poll(&pfd, 1, wait_ms) <= 0) {
+            ok = 0;
+            break;
+        }
+        ssize_t n = read(master, buf, sizeof(buf));
+        if (n <= 0) {
+            break;                       // EIO: the program has exited and closed the terminal
+        }
+        replay_append(out, buf, (size_t)n);
+        size_t len = out->len;
+        int prompt = (len >= 1 && out->data[len - 1] == ':') ||
+                     (len >= 2 && out->data[len - 2] == ':' && out->data[len - 1] == ' ');
+        if (!prompt) {
+            continue;
+        }
+        if (stats != NULL) {
+            replay_prompt_sample(stats, out, mark, first, (replay_now() - sent)*1e3);
+        }
+        first = 0;
+        mark = len;
+        if (next < end) {
+            const char *eol = memchr(next, '\n', (size_t)(end - next));
+            size_t line = eol ? (size_t)(eol - next) + 1 : (size_t)(end - next);
+            sent = replay_now();
+            if (write(master, next, line) != (ssize_t)line || (eol == NULL && write(master, "\n", 1) != 1)) {
+                ok = 0;
+                break;
+            }
+            next += line;
+        } else {
+            sent = replay_now();
+            if (write(master, "\x04", 1) != 1) {
+                ok = 0;
+                break;
+            }
+        }
+    }
+    close(master);
+    if (!ok) {
+        kill(pid, SIGKILL);
+    }
+    return replay_wait(pid, deadline) && ok;
+}
+
+//The whole script at once on stdin. Scripts are far smaller than a pipe buffer, so the write cannot
+//block while the program is still writing its output.
+static int replay_pipe(const char *program, const replay_script *script, double timeout, replay_output *out) {
+    int in[2];
+    int res[2];
+    char buf[REPLAY_CHUNK];
+
+    if (pipe2(in, O_CLOEXEC) != 0) {
+        return 0;
+    }
+    if (pipe2(res, O_CLOEXEC) != 0) {
+        close(in[0]);
+        close(in[1]);
+        return 0;
+    }
+    pid_t pid = replay_spawn(program, in[0], res[1]);
+    close(in[0]);
+    close(res[1]);
+    if (pid < 0) {
+        close(in[1]);
+        close(res[0]);
+        return 0;
+    }
+
+    int ok = write(in[1], script->input, script->input_len) == (ssize_t)script->input_len;
+    close(in[1]);
+    double deadline = replay_now() + timeout;
+    for (;;) {
+        struct pollfd pfd = {res[0], POLLIN, 0};
+        int wait_ms = (int)((deadline - replay_now())*1e3);
+        if (wait_ms <= 0 || poll(&pfd, 1, wait_ms) <= 0) {
+            ok = 0;
+            break;
+        }
+        ssize_t n = read(res[0], buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+        replay_append(out, buf, (size_t)n);
+    }
+    close(res[0]);
+    if (!ok) {
+        kill(pid, SIGKILL);
+    }
+    return replay_wait(pid, deadline) && ok;
+}
+
+//Start the program on the given stdin and stdout. Every descriptor the harness opens is close-on-exec,
+//so sessions started at the same time on other threads never hold each other's pipes or terminals open.
+static pid_t replay_spawn(const char *program, int in, int out) {
+    posix_spawn_file_actions_t actions;
+    char *argv[] = {(char *)program, NULL};
+    pid_t pid;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in, STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out, STDOUT_FILENO);
+    int err = posix_spawn(&pid, program, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    return err == 0 ? pid : -1;
+}
+
+//Reap the program, killing it if it outlives the deadline. A pidfd becomes readable when the program
+//exits, so there is no polling. Any exit status counts as finished, the transcript decides whether the
+//session was right.
+static int replay_wait(pid_t pid, double deadline) {
+    int status;
+    int fd = (int)syscall(SYS_pidfd_open, pid, 0);
+
+    if (fd >= 0) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int wait_ms = (int)((deadline - replay_now())*1e3);
+        if (wait_ms > 0) {
+            poll(&pfd, 1, wait_ms);
+        }
+        close(fd);
+    } else {
+        while (replay_now() < deadline && waitpid(pid, &status, WNOHANG) == 0) {
+            usleep(100);
+        }
+    }
+    pid_t r = waitpid(pid, &status, WNOHANG);
+    if (r == pid) {
+        return !WIFSIGNALED(status);
+    }
+    if (r == 0) {
+        kill(pid, SIGKILL);
+        waitpid(pid, &status, 0);
+    }
+    return 0;
+}
+
+//Prompts are keyed by the last line written since the previous answer (answers are not echoed, so
+//prompts share lines). The first one of a session also counts program start up.
+static void replay_prompt_sample(replay_stats *stats, const replay_output *out, size_t mark, int first, double ms) {
+    char text[REPLAY_PROMPT_TEXT];
+    size_t start = out->len;
+    while (start > mark && out->data[start - 1] != '\n') {
+        start--;
+    }
+    snprintf(text, sizeof(text), "%s%.*s", first ? "(start) " : "", (int)(out->len - start), out->data + start);
+
+    int p;
+    for (p = 0; p < stats->prompts; p++) {
+        if (strcmp(stats->prompt[p].text, text) == 0) {
+            break;
+        }
+    }
+    if (p == stats->prompts) {
+        if (stats->prompts == REPLAY_MAX_PROMPTS) {
+            return;
+        }
+        snprintf(stats->prompt[p].text, sizeof(stats->prompt[p].text), "%s", text);
+        stats->prompts++;
+    }
+    replay_push(&stats->prompt[p].samples, ms);
+}
+
+static void replay_merge(replay_stats *into, replay_stats *from) {
+    for (int p = 0; p < from->prompts; p++) {
+        int q;
+        for (q = 0; q < into->prompts; q++) {
+            if (strcmp(into->prompt[q].text, from->prompt[p].text) == 0) {
+                break;
+            }
+        }
+        if (q == into->prompts) {
+            if (into->prompts == REPLAY_MAX_PROMPTS) {
+                continue;
+            }
+            memcpy(into->prompt[q].text, from->prompt[p].text, sizeof(into->prompt[q].text));
+            into->prompts++;
+        }
+        for (size_t i = 0; i < from->prompt[p].samples.count; i++) {
+            replay_push(&into->prompt[q].samples, from->prompt[p].samples.ms[i]);
+        }
+    }
+    for (int s = 0; s < REPLAY_MAX_SCRIPTS; s++) {
+        for (size_t i = 0; i < from->session[s].count; i++) {
+            replay_push(&into->session[s], from->session[s].ms[i]);
+        }
+    }
+    into->mismatches += from->mismatches;
+    into->failures += from->failures;
+    if (into->first_script < 0 && from->first_script >= 0) {
+        into->first_script = from->first_script;
+        into->first_output = from->first_output;
+        into->first_len = from->first_len;
+    }
+}
+
+static int replay_compare(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void replay_report_samples(const char *name, replay_samples *samples) {
+    if (samples->count == 0) {
+        return;
+    }
+    qsort(samples->ms, samples->count, sizeof(double), replay_compare);
+    size_t p99 = (size_t)(0.99*(double)(samples->count - 1) + 0.5);
+    printf("  %-46.46s%8zu %8.3f %8.3f %8.3f\n", name, samples->count,
+           samples->ms[(samples->count - 1)/2], samples->ms[p99], samples->ms[samples->count - 1]);
+}
+
+//Print the first line where a transcript left its golden copy, and keep the whole transcript for a diff
+static void replay_first_difference(const replay_script *script, const char *output, size_t len) {
+    size_t i = 0;
+    size_t line_start = 0;
+    int line = 1;
+    char path[300];
+
+    while (i < len && i < script->golden_len && output[i] == script->golden[i]) {
+        if (output[i] == '\n') {
+            line++;
+            line_start = i + 1;
+        }
+        i++;
+    }
+    const char *want = script->golden + line_start;
+    const char *got = output + line_start;
+    int want_len = (int)strcspn(want, "\n");
+    int got_len = (int)strcspn(got, "\n");
+    if (line_start + (size_t)want_len > script->golden_len) want_len = (int)(script->golden_len - line_start);
+    if (line_start + (size_t)got_len > len) got_len = (int)(len - line_start);
+
+    printf("\nFirst mismatch: %s, line %d\n", script->path, line);
+    printf("  expected: %.*s%s\n", want_len, want, line_start >= script->golden_len ? "(end of transcript)" : "");
+    printf("  got:      %.*s%s\n", got_len, got, line_start >= len ? "(end of transcript)" : "");
+
+    snprintf(path, sizeof(path), "%s.actual", script->golden_path);
+    FILE *fp = fopen(path, "wb");
+    if (fp != NULL) {
+        fwrite(output, 1, len, fp);
+        fclose(fp);
+        printf("  full transcript in %s\n", path);
+    }
+}
+
+//Rewrite "<number> ns", "<number> us" and "<number> ms" as "# ns" and so on, in place. Return the new length.
+static size_t replay_mask_times(char *data, size_t len) {
+    size_t in = 0;
+    size_t out = 0;
+    while (in < len) {
+        //a number starts after a character that cannot be part of a word or another number
+        int starts = isdigit((unsigned char)data[in])
+                     && (in == 0 || (!isalnum((unsigned char)data[in - 1]) && data[in - 1] != '.'));
+        if (!starts) {
+            data[out++] = data[in++];
+            continue;
+        }
+        size_t end = in;
+        while (end < len && (isdigit((unsigned char)data[end]) || data[end] == '.')) {
+            end++;
+        }
+        int unit = end + 3 <= len && data[end] == ' '
+                   && (data[end + 1] == 'n' || data[end + 1] == 'u' || data[end + 1] == 'm') && data[end + 2] == 's'
+                   && (end + 3 == len || !isalnum((unsigned char)data[end + 3]));
+        if (unit) {
+            data[out++] = '#';
+            in = end;
+        }
+        while (in < end) {
+            data[out++] = data[in++];
+        }
+    }
+    if (data != NULL) {
+        data[out] = '\0';
+    }
+    return out;
+}
+
+static void replay_append(replay_output *out, const char *data, size_t len) {
+    if (out->len + len + 1 > out->cap) {
+        size_t cap = out->cap ? out->cap : REPLAY_CHUNK;
+        while (cap < out->len + len + 1) {
+            cap *= 2;
+        }
+        char *grown = realloc(out->data, cap);
+        if (grown == NULL) {
+            return;
+        }
+        out->data = grown;
+        out->cap = cap;
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+    out->data[out->len] = '\0';
+}
+
+static void replay_push(replay_samples *samples, double ms) {
+    if (samples->count == samples->cap) {
+        size_t cap = samples->cap ? 2*samples->cap : 256;
+        double *grown = realloc(samples->ms, cap*sizeof(double));
+        if (grown == NULL) {
+            return;
+        }
+        samples->ms = grown;
+        samples->cap = cap;
+    }
+    samples->ms[samples->count++] = ms;
+}
+
+static int replay_read_file(const char *path, char **data, size_t *len) {
+    FILE *fp = fopen(path, "rb");
+    replay_output out = {0};
+    char buf[REPLAY_CHUNK];
+    size_t n;
+
+    if (fp == NULL) {
+        return 0;
+    }
+    replay_append(&out, "", 0);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        replay_append(&out, buf, n);
+    }
+    fclose(fp);
+    *data = out.data;
+    *len = out.len;
+    return out.data != NULL;
+}
+
+static double replay_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+static void replay_usage(void) {
+    printf("Usage: replay.out [--pipe] [--record] [--sessions N] [--jobs J] [--timeout s] <program> <script.in>...\n");
+}
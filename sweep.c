@@ -0,0 +1,638 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "sweep.h"
+//Sharded, checkpointed parameter sweeps.
+//The index space is split into N contiguous shards. Each worker appends its rows to its own file and
+//checkpoints (next index, output bytes) by writing a temp file and renaming it over the old one, so a
+//worker killed at any moment resumes from the last checkpoint and drops any rows written after it.
+//A worker holds an flock on shard_k_of_N.lock while it runs, so two processes never run the same shard.
+
+static const struct {
+    const char *key;
+    size_t offset;
+} sweep_keys[SWEEP_AXES] = {
+    {"vin_min",     offsetof(converter_input, vin_min)},
+    {"vin_max",     offsetof(converter_input, vin_max)},
+    {"v_out",       offsetof(converter_input, v_out)},
+    {"p_out",       offsetof(converter_input, p_out)},
+    {"f_switch",    offsetof(converter_input, f_switch)},
+    {"ripple_i",    offsetof(converter_input, ripple_i_percent)},
+    {"ripple_i_1",  offsetof(converter_input, ripple_i_1_percent)},
+    {"ripple_i_2",  offsetof(converter_input, ripple_i_2_percent)},
+    {"ripple_v",    offsetof(converter_input, ripple_v_percent)},
+    {"ripple_v_cn", offsetof(converter_input, ripple_v_cn_percent)}
+};
+
+static precision_mode sweep_select_precision(const sweep_spec *spec);
+static int  sweep_path(char *path, size_t size, const char *dir, const char *kind, int shard, int shards);
+static int  sweep_sync_dir(const char *path);
+static int  sweep_lock_shard(const char *dir, int shard, int shards);
+static int  sweep_load_checkpoint(const char *path, sweep_checkpoint *ckpt);
+static int  sweep_save_checkpoint(const char *path, const sweep_checkpoint *ckpt);
+static int  sweep_parse_shard(const char *text, int *shard, int *shards);
+static void sweep_usage(void);
+static void sweep_write_magnetics(FILE *out, const mag_db *db, const mag_choice *choice);
+
+//Command line entry:
+//  main.out sweep <spec> <dir> [--shard k/N | --workers N] [--limit points]
+//  main.out merge <spec> <dir> <N>
+int sweep_main(int argc, char **argv) {
+    sweep_spec spec;
+    int shard = 0;
+    int shards = 1;
+    int workers = 0;
+    uint64_t limit = UINT64_MAX;
+
+    if (argc < 4) {
+        sweep_usage();
+        return 1;
+    }
+    if (!sweep_load_spec(argv[2], &spec)) {
+        return 1;
+    }
+    //Worker processes share the cores for the magnetics search
+    spec.threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (mkdir(argv[3], 0777) != 0 && errno != EEXIST) {
+        perror("mkdir");
+        return 1;
+    }
+    if (strcmp(argv[1], "merge") == 0) {
+        if (argc < 5 || (shards = atoi(argv[4])) < 1) {
+            sweep_usage();
+            return 1;
+        }
+        return sweep_merge(&spec, argv[3], shards) ? 0 : 1;
+    }
+
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+            if (!sweep_parse_shard(argv[++i], &shard, &shards)) {
+                sweep_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--limit") == 0 && i + 1 < argc) {
+            limit = strtoull(argv[++i], NULL, 10);
+        }
+        else {
+            sweep_usage();
+            return 1;
+        }
+    }
+
+    if (workers > 0) {
+        //local run: one process per shard, then merge
+        int failed = 0;
+        spec.threads = spec.threads/workers > 1 ? spec.threads/workers : 1;
+        fflush(stdout);
+        for (int k = 0; k < workers; k++) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0) {
+                int ok = sweep_run_shard(&spec, argv[3], k, workers, limit);
+                fflush(stdout);
+                _exit(ok ? 0 : 1);
+            }
+        }
+        for (int k = 0; k < workers; k++) {
+            int status;
+            if (wait(&status) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                failed = 1;
+            }
+        }
+        if (failed) {
+            printf("Some shards did not finish, run again to resume\n");
+            return 1;
+        }
+        return sweep_merge(&spec, argv[3], workers) ? 0 : 1;
+    }
+    return sweep_run_shard(&spec, argv[3], shard, shards, limit) ? 0 : 1;
+}
+
+static void sweep_usage(void) {
+    printf("Usage: main.out sweep <spec> <dir> [--shard k/N | --workers N] [--limit points]\n");
+    printf("       main.out merge <spec> <dir> <N>\n");
+}
+
+static int sweep_parse_shard(const char *text, int *shard, int *shards) {
+    if (sscanf(text, "%d/%d", shard, shards) != 2 || *shards < 1 || *shard < 0 || *shard >= *shards) {
+        return 0;
+    }
+    return 1;
+}
+
+//Spec file, one "key = value" per line, '#' starts a comment:
+//  topology  = buck | boost | buck_boost | cuk
+//  <axis>    = value | lo hi points      (axes as in sweep_keys)
+//  precision = double | float | fixed
+//  tolerance = relative error in %
+//  cores     = core database for a magnetics column set per inductor
+//  objective = loss | volume          (magnetics, default loss)
+//  j_max     = current density in A/mm^2 (magnetics, default 5)
+int sweep_load_spec(const char *path, sweep_spec *spec) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    int line_no = 0;
+
+    if (!fp) {
+        perror("fopen");
+        return 0;
+    }
+    memset(spec, 0, sizeof(*spec));
+    spec->precision = prec_double;
+    spec->tolerance = 1e-3;
+    spec->magnetics.j_max = 5.0;
+    spec->magnetics.objective = mag_min_loss;
+    spec->hash = 1469598103934665603ULL;
+    for (int i = 0; i < SWEEP_AXES; i++) {
+        spec->axis[i].points = 1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_no++;
+        //FNV-1a of the whole file
+        for (const char *c = line; *c; c++) {
+            spec->hash = (spec->hash ^ (unsigned char)*c)*1099511628211ULL;
+        }
+        line[strcspn(line, "#\r\n")] = '\0';
+        char key[32];
+        char value[128];
+        if (sscanf(line, " %31[a-z_0-9] = %127[^\n]", key, value) != 2) {
+            continue;
+        }
+        if (strcmp(key, "topology") == 0) {
+            if (strncmp(value, "buck_boost", 10) == 0) {spec->type = buck_boost_conv;}
+            else if (strncmp(value, "buck", 4) == 0) {spec->type = buck_conv;}
+            else if (strncmp(value, "boost", 5) == 0) {spec->type = boost_conv;}
+            else if (strncmp(value, "cuk", 3) == 0) {spec->type = cuk_conv;}
+            else {
+                printf("ERROR: %s:%d unknown topology\n", path, line_no);
+                fclose(fp);
+                return 0;
+            }
+            continue;
+        }
+        if (strcmp(key, "precision") == 0) {
+            char word[16] = "";
+            sscanf(value, "%15s", word);
+            if (strcmp(word, "double") == 0) {spec->precision = prec_double;}
+            else if (strcmp(word, "float") == 0) {spec->precision = prec_float;}
+            else if (strcmp(word, "fixed") == 0) {spec->precision = prec_fixed;}
+            else {
+                printf("ERROR: %s:%d unknown precision\n", path, line_no);
+                fclose(fp);
+                return 0;
+            }
+            continue;
+        }
+        if (strcmp(key, "tolerance") == 0) {
+            spec->tolerance = atof(value)/100.0;
+            continue;
+        }
+        if (strcmp(key, "cores") == 0) {
+            sscanf(value, "%255s", spec->cores);
+            continue;
+        }
+        if (strcmp(key, "objective") == 0) {
+            spec->magnetics.objective = strncmp(value, "volume", 6) == 0 ? mag_min_volume : mag_min_loss;
+            continue;
+        }
+        if (strcmp(key, "j_max") == 0) {
+            spec->magnetics.j_max = atof(value);
+            continue;
+        }
+        int axis = -1;
+        for (int i = 0; i < SWEEP_AXES; i++) {
+            if (strcmp(key, sweep_keys[i].key) == 0) {axis = i;}
+        }
+        if (axis < 0) {
+            printf("ERROR: %s:%d unknown key %s\n", path, line_no, key);
+            fclose(fp);
+            return 0;
+        }
+        sweep_axis *a = &spec->axis[axis];
+        int fields = sscanf(value, "%lf %lf %" SCNu64, &a->lo, &a->hi, &a->points);
+        if (fields == 1) {
+            a->hi = a->lo;
+            a->points = 1;
+        }
+        else if (fields != 3 || a->points < 1) {
+            printf("ERROR: %s:%d expected value or lo hi points\n", path, line_no);
+            fclose(fp);
+            return 0;
+        }
+    }
+    fclose(fp);
+
+    spec->total = 1;
+    for (int i = 0; i < SWEEP_AXES; i++) {
+        if (spec->total > UINT64_MAX/spec->axis[i].points) {
+            printf("ERROR: %s has more than 2^64 points\n", path);
+            return 0;
+        }
+        spec->total *= spec->axis[i].points;
+    }
+    return 1;
+}
+
+//Mixed-radix decode of a sweep index, last axis fastest
+void sweep_point(const sweep_spec *spec, uint64_t index, converter_input *input) {
+    memset(input, 0, sizeof(*input));
+    input->type = spec->type;
+    for (int i = SWEEP_AXES - 1; i >= 0; i--) {
+        const sweep_axis *a = &spec->axis[i];
+        uint64_t digit = index % a->points;
+        index /= a->points;
+        double value = a->lo;
+        if (a->points > 1) {
+            value += (a->hi - a->lo)*(double)digit/(double)(a->points - 1);
+        }
+        *(double *)((char *)input + sweep_keys[i].offset) = value;
+    }
+}
+
+//Shard k of N covers [first, last). Sizes differ by at most one point.
+void sweep_shard_range(uint64_t total, int shard, int shards, uint64_t *first, uint64_t *last) {
+    uint64_t base = total/shards;
+    uint64_t extra = total%shards;
+    *first = base*shard + ((uint64_t)shard < extra ? (uint64_t)shard : extra);
+    *last = *first + base + ((uint64_t)shard < extra ? 1 : 0);
+}
+
+//Audit points spread evenly over the whole index space, so every shard makes the same choice.
+static precision_mode sweep_select_precision(const sweep_spec *spec) {
+    precision_report report;
+    if (spec->precision == prec_double) {
+        return prec_double;
+    }
+    converter_input *inputs = malloc(PRECISION_AUDIT_SAMPLES*sizeof(converter_input));
+    if (!inputs) {
+        return prec_double;
+    }
+    int n = 0;
+    for (int i = 0; i < PRECISION_AUDIT_SAMPLES && (uint64_t)i < spec->total; i++) {
+        uint64_t index = (uint64_t)((double)i/PRECISION_AUDIT_SAMPLES*(double)spec->total);
+        sweep_point(spec, index, &inputs[n]);
+        if (!converter_validate(&inputs[n])) {n++;}
+    }
+    precision_mode mode = precision_select(spec->precision, inputs, n, spec->tolerance, &report);
+    free(inputs);
+    return mode;
+}
+
+//Return 0 if the path does not fit in size
+static int sweep_path(char *path, size_t size, const char *dir, const char *kind, int shard, int shards) {
+    int len = snprintf(path, size, "%s/shard_%d_of_%d.%s", dir, shard, shards, kind);
+    if (len < 0 || (size_t)len >= size) {
+        printf("ERROR: path in %s is too long\n", dir);
+        return 0;
+    }
+    return 1;
+}
+
+//fsync the directory holding path, so a rename into it survives a power cut
+static int sweep_sync_dir(const char *path) {
+    char dir[512];
+    const char *slash = strrchr(path, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    }
+    else {
+        size_t len = (size_t)(slash - path);
+        if (len == 0) {len = 1;}  // "/file" lives in "/"
+        if (len >= sizeof(dir)) {
+            return 0;
+        }
+        memcpy(dir, path, len);
+        dir[len] = '\0';
+    }
+    int fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        perror("open");
+        return 0;
+    }
+    int ok = fsync(fd) == 0;
+    if (!ok) {perror("fsync");}
+    close(fd);
+    return ok;
+}
+
+//The checkpoint itself is replaced by rename, so the lock lives on a file that stays put.
+//Return the locked descriptor, closing it releases the lock, or -1 if another process has the shard.
+static int sweep_lock_shard(const char *dir, int shard, int shards) {
+    char path[512];
+    if (!sweep_path(path, sizeof(path), dir, "lock", shard, shards)) {
+        return -1;
+    }
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        perror("open");
+        return -1;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno == EWOULDBLOCK) {
+            printf("Shard %d/%d is already being run by another process\n", shard, shards);
+        }
+        else {
+            perror("flock");
+        }
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int sweep_load_checkpoint(const char *path, sweep_checkpoint *ckpt) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return 0;
+    }
+    int fields = fscanf(fp, "spec=%" SCNx64 " shard=%d/%d next=%" SCNu64 " bytes=%ld done=%d",
+                        &ckpt->hash, &ckpt->shard, &ckpt->shards, &ckpt->next, &ckpt->bytes, &ckpt->done);
+    fclose(fp);
+    return fields == 6;
+}
+
+//Write to a temp file, sync it, rename it over the old checkpoint and sync the directory
+static int sweep_save_checkpoint(const char *path, const sweep_checkpoint *ckpt) {
+    char tmp[512];
+    int len = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if (len < 0 || (size_t)len >= sizeof(tmp)) {
+        printf("ERROR: path %s is too long\n", path);
+        return 0;
+    }
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) {
+        perror("fopen");
+        return 0;
+    }
+    fprintf(fp, "spec=%016" PRIx64 "\nshard=%d/%d\nnext=%" PRIu64 "\nbytes=%ld\ndone=%d\n",
+            ckpt->hash, ckpt->shard, ckpt->shards, ckpt->next, ckpt->bytes, ckpt->done);
+    if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+        perror("fsync");
+        fclose(fp);
+        return 0;
+    }
+    fclose(fp);
+    if (rename(tmp, path) != 0) {
+        perror("rename");
+        return 0;
+    }
+    return sweep_sync_dir(path);
+}
+
+//Calculate shard k of N, resuming from its checkpoint. Stops after limit points (for testing resume).
+//Return 1 when the shard is complete.
+int sweep_run_shard(const sweep_spec *spec, const char *dir, int shard, int shards, uint64_t limit) {
+    char out_path[512];
+    char ckpt_path[512];
+    sweep_checkpoint ckpt;
+    uint64_t first, last;
+
+    sweep_shard_range(spec->total, shard, shards, &first, &last);
+    if (!sweep_path(out_path, sizeof(out_path), dir, "csv", shard, shards)
+        || !sweep_path(ckpt_path, sizeof(ckpt_path), dir, "ckpt", shard, shards)) {
+        return 0;
+    }
+    int lock = sweep_lock_shard(dir, shard, shards);
+    if (lock < 0) {
+        return 0;
+    }
+    if (!sweep_load_checkpoint(ckpt_path, &ckpt) || ckpt.hash != spec->hash
+        || ckpt.shard != shard || ckpt.shards != shards) {
+        ckpt.hash = spec->hash;
+        ckpt.shard = shard;
+        ckpt.shards = shards;
+        ckpt.next = first;
+        ckpt.bytes = 0;
+        ckpt.done = 0;
+    }
+    if (ckpt.done) {
+        printf("Shard %d/%d already complete\n", shard, shards);
+        close(lock);
+        return 1;
+    }
+
+    FILE *out = fopen(out_path, "r+");
+    if (!out) {out = fopen(out_path, "w+");}
+    if (!out) {
+        perror("fopen");
+        close(lock);
+        return 0;
+    }
+    //drop rows written after the last checkpoint
+    if (ftruncate(fileno(out), ckpt.bytes) != 0 || fseek(out, ckpt.bytes, SEEK_SET) != 0) {
+        perror("ftruncate");
+        fclose(out);
+        close(lock);
+        return 0;
+    }
+
+    converter_input *inputs = malloc(SWEEP_BATCH*sizeof(converter_input));
+    converter_result *results = malloc(SWEEP_BATCH*sizeof(converter_result));
+    //Magnetics: up to two inductors per point, searched for the whole batch at once
+    mag_db *db = NULL;
+    mag_inductor *inductors = NULL;
+    mag_choice *choices = NULL;
+    int *first_inductor = NULL;
+    if (spec->cores[0]) {
+        db = malloc(sizeof(mag_db));
+        inductors = malloc(2*SWEEP_BATCH*sizeof(mag_inductor));
+        choices = malloc(2*SWEEP_BATCH*sizeof(mag_choice));
+        first_inductor = malloc(SWEEP_BATCH*sizeof(int));
+    }
+    if (!inputs || !results || (spec->cores[0] && (!db || !inductors || !choices || !first_inductor))
+        || (db && !mag_load_db(spec->cores, db))) {
+        free(inputs);
+        free(results);
+        free(db);
+        free(inductors);
+        free(choices);
+        free(first_inductor);
+        fclose(out);
+        close(lock);
+        return 0;
+    }
+    precision_mode mode = sweep_select_precision(spec);
+    if (ckpt.next > first) {
+        printf("Shard %d/%d resuming at %" PRIu64 " of [%" PRIu64 ", %" PRIu64 ") in %s\n",
+               shard, shards, ckpt.next, first, last, precision_name(mode));
+    }
+
+    uint64_t done_now = 0;
+    uint64_t since_ckpt = 0;
+    int ok = 1;
+    while (ckpt.next < last && done_now < limit) {
+        uint64_t n = last - ckpt.next;
+        if (n > SWEEP_BATCH) {n = SWEEP_BATCH;}
+        if (n > limit - done_now) {n = limit - done_now;}
+        for (uint64_t i = 0; i < n; i++) {
+            sweep_point(spec, ckpt.next + i, &inputs[i]);
+        }
+        precision_calculate(mode, inputs, results, (int)n);
+        if (db) {
+            size_t count = 0;
+            for (uint64_t i = 0; i < n; i++) {
+                first_inductor[i] = (int)count;
+                if (!converter_validate(&inputs[i])) {
+                    count += (size_t)mag_inductors(&inputs[i], &results[i], &inductors[count]);
+                }
+            }
+            mag_search_batch(db, &spec->magnetics, inductors, choices, count, spec->threads);
+        }
+        for (uint64_t i = 0; i < n; i++) {
+            const converter_input *in = &inputs[i];
+            const converter_result *r = &results[i];
+            if (converter_validate(in)) {
+                continue;
+            }
+            fprintf(out, "%" PRIu64 ", %.6g, %.6g, %.6g, %.6g, %.6g, %.6f, %.6g, %.6e, %.6e, %.6e, %.6e, %.6e, %.6e",
+                    ckpt.next + i, in->vin_min, in->vin_max, in->v_out, in->p_out, in->f_switch,
+                    r->duty_cycle, r->r_load, r->L, r->C, r->L1, r->L2, r->Co, r->Cn);
+            if (db) {
+                sweep_write_magnetics(out, db, &choices[first_inductor[i]]);
+                if (in->type == cuk_conv) {sweep_write_magnetics(out, db, &choices[first_inductor[i] + 1]);}
+            }
+            fputc('\n', out);
+        }
+        ckpt.next += n;
+        done_now += n;
+        since_ckpt += n;
+        if (since_ckpt >= SWEEP_CHECKPOINT || ckpt.next == last || done_now == limit) {
+            if (fflush(out) != 0 || fsync(fileno(out)) != 0) {
+                perror("fsync");
+                ok = 0;
+                break;
+            }
+            ckpt.bytes = ftell(out);
+            ckpt.done = ckpt.next == last;
+            if (!sweep_save_checkpoint(ckpt_path, &ckpt)) {
+                ok = 0;
+                break;
+            }
+            since_ckpt = 0;
+        }
+    }
+    free(inputs);
+    free(results);
+    free(db);
+    free(inductors);
+    free(choices);
+    free(first_inductor);
+    fclose(out);
+    close(lock);
+    return ok && ckpt.done;
+}
+
+//Core, turns, wire and losses of one inductor, or dashes if nothing in the database fits
+static void sweep_write_magnetics(FILE *out, const mag_db *db, const mag_choice *choice) {
+    char wire[32];
+    if (choice->core < 0) {
+        fprintf(out, ", -, 0, -, 0, 0");
+        return;
+    }
+    mag_wire_name(db, choice->wire, wire, sizeof(wire));
+    fprintf(out, ", %s, %d, %s, %.4g, %.4g", db->core[choice->core].name, choice->turns, wire,
+            choice->p_core, choice->p_copper);
+}
+
+//Join the shard outputs in index order into dir/sweep_results.csv. Every shard must be complete.
+int sweep_merge(const sweep_spec *spec, const char *dir, int shards) {
+    char path[512];
+    char tmp[512];
+    char buf[65536];
+    int missing = 0;
+
+    for (int k = 0; k < shards; k++) {
+        sweep_checkpoint ckpt;
+        if (!sweep_path(path, sizeof(path), dir, "ckpt", k, shards)) {
+            return 0;
+        }
+        if (!sweep_load_checkpoint(path, &ckpt) || ckpt.hash != spec->hash || !ckpt.done) {
+            printf("Shard %d/%d is not complete\n", k, shards);
+            missing = 1;
+        }
+    }
+    if (missing) {
+        return 0;
+    }
+
+    int len = snprintf(path, sizeof(path), "%s/sweep_results.csv", dir);
+    int tmp_len = snprintf(tmp, sizeof(tmp), "%s/sweep_results.csv.tmp", dir);
+    if (len < 0 || (size_t)len >= sizeof(path) || tmp_len < 0 || (size_t)tmp_len >= sizeof(tmp)) {
+        printf("ERROR: path in %s is too long\n", dir);
+        return 0;
+    }
+    FILE *out = fopen(tmp, "w");
+    if (!out) {
+        perror("fopen");
+        return 0;
+    }
+    fprintf(out, "index, Vin_min, Vin_max, Vout, Pout, f_sw, D, R_load, L, C, L1, L2, Co, Cn");
+    if (spec->cores[0]) {
+        fprintf(out, ", core, N, wire, P_core, P_cu");
+        if (spec->type == cuk_conv) {fprintf(out, ", core2, N2, wire2, P_core2, P_cu2");}
+    }
+    fprintf(out, "\n");
+    for (int k = 0; k < shards; k++) {
+        sweep_checkpoint ckpt;
+        char shard_path[512];
+        //both paths fitted in the check above, which used the longer "ckpt"
+        sweep_path(shard_path, sizeof(shard_path), dir, "ckpt", k, shards);
+        sweep_load_checkpoint(shard_path, &ckpt);
+        sweep_path(shard_path, sizeof(shard_path), dir, "csv", k, shards);
+        FILE *in = fopen(shard_path, "r");
+        if (!in) {
+            perror("fopen");
+            fclose(out);
+            return 0;
+        }
+        long left = ckpt.bytes;
+        size_t got;
+        while (left > 0 && (got = fread(buf, 1, left < (long)sizeof(buf) ? (size_t)left : sizeof(buf), in)) > 0) {
+            if (fwrite(buf, 1, got, out) != got) {
+                break;
+            }
+            left -= (long)got;
+        }
+        //a short shard or a failed write would leave a merged file that looks complete
+        if (left != 0) {
+            printf("ERROR: could not copy %ld bytes of %s\n", left, shard_path);
+            fclose(in);
+            fclose(out);
+            return 0;
+        }
+        fclose(in);
+    }
+    if (fflush(out) != 0 || fsync(fileno(out)) != 0) {
+        perror("fsync");
+        fclose(out);
+        return 0;
+    }
+    fclose(out);
+    if (rename(tmp, path) != 0) {
+        perror("rename");
+        return 0;
+    }
+    if (!sweep_sync_dir(path)) {
+        return 0;
+    }
+    printf("Merged %d shards of %" PRIu64 " points into %s\n", shards, spec->total, path);
+    return 1;
+}
@@ -0,0 +1,50 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include "funcs.h"
+#include "precision.h"
+#include "magnetics.h"
+
+#define SWEEP_AXES        10     // every double in converter_input, vin_min to ripple_v_cn_percent
+#define SWEEP_BATCH       4096   // points calculated per call
+#define SWEEP_CHECKPOINT  262144 // points between checkpoints
+
+//One axis of the sweep grid, lo and hi included
+typedef struct {
+    double lo;
+    double hi;
+    uint64_t points;
+} sweep_axis;
+
+//Sweep read from a spec file. The index space is the product of the axis points, last axis fastest.
+typedef struct {
+    converter_type type;
+    sweep_axis axis[SWEEP_AXES];
+    precision_mode precision;
+    double tolerance;  // relative, for precision_select
+    uint64_t total;
+    uint64_t hash;     // of the spec file, so shards of different sweeps are never mixed
+    char cores[256];   // core database, empty for no magnetics columns
+    mag_limits magnetics;
+    int threads;       // for the magnetics search in each worker, set by sweep_main
+} sweep_spec;
+
+//Progress of one shard, written atomically next to its output
+typedef struct {
+    uint64_t hash;
+    int shard;
+    int shards;
+    uint64_t next;     // next index to calculate
+    long bytes;        // output bytes that belong to indices before next
+    int done;
+} sweep_checkpoint;
+
+int  sweep_main(int argc, char **argv);
+int  sweep_load_spec(const char *path, sweep_spec *spec);
+void sweep_point(const sweep_spec *spec, uint64_t index, converter_input *input);
+void sweep_shard_range(uint64_t total, int shard, int shards, uint64_t *first, uint64_t *last);
+int  sweep_run_shard(const sweep_spec *spec, const char *dir, int shard, int shards, uint64_t limit);
+int  sweep_merge(const sweep_spec *spec, const char *dir, int shards);
+
+#endif
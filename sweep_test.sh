@@ -0,0 +1,89 @@
+# Bash shell script to check sharded sweeps.
+# Runs a sweep with one worker as the reference, then with 4 workers that are stopped early,
+# one of them killed, and resumed. The merged results must be byte for byte the same.
+# Then checks that a short shard fails the merge and that a misspelt precision is rejected.
+
+spec_dir=$(mktemp -d)
+trap 'rm -rf "$spec_dir"' EXIT
+spec="$spec_dir/spec.txt"
+cat > "$spec" <<EOF
+topology = buck
+vin_min  = 40 60 50
+vin_max  = 70
+v_out    = 5 30 400
+p_out    = 100 1000 100
+f_switch = 100000
+ripple_i = 20
+ripple_v = 1
+EOF
+
+failed=0
+
+echo "Reference run with one worker..."
+./main.out sweep "$spec" "$spec_dir/reference" --workers 1 > /dev/null || failed=1
+
+echo "4 workers stopped after 100000 points each..."
+if ./main.out sweep "$spec" "$spec_dir/sharded" --workers 4 --limit 100000 > /dev/null; then
+  echo "Fail: the limited run reported complete"
+  failed=1
+fi
+
+echo "4 workers, one killed part way..."
+./main.out sweep "$spec" "$spec_dir/sharded" --workers 4 > /dev/null &
+parent=$!
+sleep 1
+if pkill -KILL -n -P $parent; then
+  if wait $parent; then
+    echo "Fail: the run with a killed worker reported complete"
+    failed=1
+  fi
+else
+  wait $parent
+  echo "Note: every worker had finished before the kill, resume is only checked from the limit"
+fi
+
+echo "A shard that is locked cannot be run twice..."
+if flock "$spec_dir/sharded/shard_0_of_4.lock" ./main.out sweep "$spec" "$spec_dir/sharded" --shard 0/4 > "$spec_dir/locked.txt"; then
+  echo "Fail: shard 0/4 ran while another process held its lock"
+  failed=1
+elif ! grep -q "already being run" "$spec_dir/locked.txt"; then
+  echo "Fail: shard 0/4 did not report its lock"
+  failed=1
+fi
+
+echo "Resume and merge..."
+./main.out sweep "$spec" "$spec_dir/sharded" --workers 4 > /dev/null || failed=1
+
+if ! cmp "$spec_dir/reference/sweep_results.csv" "$spec_dir/sharded/sweep_results.csv"; then
+  echo "Fail: resumed 4 worker sweep differs from the one worker sweep"
+  failed=1
+fi
+
+echo "A shard shorter than its checkpoint fails the merge..."
+csv=$(ls "$spec_dir"/sharded/shard_0_of_4*.csv)
+truncate -s -1 "$csv"
+if ./main.out merge "$spec" "$spec_dir/sharded" 4 > "$spec_dir/short.txt"; then
+  echo "Fail: merged a shard that lost its last byte"
+  failed=1
+elif ! grep -q "could not copy" "$spec_dir/short.txt"; then
+  echo "Fail: the short shard was not reported"
+  failed=1
+fi
+
+echo "An unknown precision is rejected..."
+sed 's/^ripple_v .*/&\nprecision = dobule/' "$spec" > "$spec_dir/typo.txt"
+if ./main.out sweep "$spec_dir/typo.txt" "$spec_dir/typo" --workers 1 > "$spec_dir/typo_log.txt"; then
+  echo "Fail: a sweep ran with precision = dobule"
+  failed=1
+elif ! grep -q "typo.txt:9 unknown precision" "$spec_dir/typo_log.txt"; then
+  echo "Fail: the unknown precision was not reported"
+  failed=1
+fi
+
+if [ $failed -eq 0 ]; then
+  echo "Sharded sweep test passed"
+  exit 0
+else
+  echo "Sharded sweep test failed"
+  exit 1
+fi
@@ -26,8 +26,53 @@ if [ ! -x ./main.out ]; then
 fi
 
 echo
-echo "Just checking the file compiled successfully, no further tests of functionality"
-echo "This is the only automated check, the rest of your project will be marked manually."
+echo "Running unit tests..."
+if [ ! -x ./tests.out ]; then
+  echo "Fail: ./tests.out not found"
+  failed=1
+elif ! ./tests.out; then
+  echo "Fail: unit tests"
+  failed=1
+fi
+
+echo
+echo "Replaying scripted sessions against their golden transcripts..."
+if [ ! -x ./replay.out ]; then
+  echo "Fail: ./replay.out not found"
+  failed=1
+elif ! replay_log=$(./replay.out ./main.out replay/*.in); then
+  echo "$replay_log"
+  echo "Fail: replay transcripts differ"
+  failed=1
+else
+  echo "$replay_log" | head -2
+fi
+
+echo
+echo "Short differential fuzz run..."
+fuzz_dir=$(mktemp -d)
+if [ ! -x ./fuzz.out ]; then
+  echo "Fail: ./fuzz.out not found"
+  failed=1
+elif ! fuzz_log=$(./fuzz.out --cases 200000 --seed 1 --out "$fuzz_dir"); then
+  echo "$fuzz_log"
+  cat "$fuzz_dir"/* 2>/dev/null
+  echo "Fail: fuzzer found mismatches"
+  failed=1
+else
+  echo "$fuzz_log" | tail -1
+fi
+rm -rf "$fuzz_dir"
+
+echo
+echo "Sharded sweep..."
+if ! sweep_log=$(bash sweep_test.sh); then
+  echo "$sweep_log"
+  echo "Fail: sharded sweep"
+  failed=1
+else
+  echo "$sweep_log" | tail -1
+fi
 
 
 echo
@@ -0,0 +1,553 @@
+// Unit tests of the library modules, run by test.sh after the build.
+// Each test checks a fast path against a slow, obviously correct one.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "funcs.h"
+#include "archive.h"
+#include "magnetics.h"
+#include "loss.h"
+#include "precision.h"
+#include "profile.h"
+
+static int checks = 0;
+static int failed = 0;
+
+static void check(int ok, const char *what)
+{
+    checks++;
+    if (!ok) {
+        failed++;
+        printf("FAIL: %s\n", what);
+    }
+}
+
+static int close_to(double a, double b, double tolerance)
+{
+    return fabs(a - b) <= tolerance*fmax(fabs(a), fabs(b));
+}
+
+/* one design per topology, the same ones the replay sessions use */
+static converter_input test_design(converter_type type)
+{
+    converter_input input = {0};
+    input.type = type;
+    switch (type) {
+        case buck_conv:
+            input.vin_max = 60; input.vin_min = 40; input.v_out = 12; input.p_out = 100;
+            input.f_switch = 100000; input.ripple_i_percent = 20; input.ripple_v_percent = 1;
+            break;
+        case boost_conv:
+            input.vin_max = 24; input.vin_min = 12; input.v_out = 48; input.p_out = 200;
+            input.f_switch = 100000; input.ripple_i_percent = 30; input.ripple_v_percent = 1;
+            break;
+        case buck_boost_conv:
+            input.vin_max = 36; input.vin_min = 18; input.v_out = 24; input.p_out = 150;
+            input.f_switch = 200000; input.ripple_i_percent = 25; input.ripple_v_percent = 0.5;
+            break;
+        case cuk_conv:
+            input.vin_max = 60; input.vin_min = 40; input.v_out = 12; input.p_out = 100;
+            input.f_switch = 100000; input.ripple_i_1_percent = 20; input.ripple_i_2_percent = 20;
+            input.ripple_v_percent = 1; input.ripple_v_cn_percent = 5;
+            break;
+    }
+    return input;
+}
+
+/* NaN passes every range check, so each field a topology uses must be caught on its own */
+static void test_converter(void)
+{
+    const double bad[] = {NAN, INFINITY, -INFINITY};
+    for (int type = buck_conv; type <= cuk_conv; type++) {
+        converter_input input = test_design((converter_type)type);
+        int cuk = type == cuk_conv;
+        int rejected = 1;
+        for (int f = 0; f < 9; f++) {
+            for (size_t k = 0; k < sizeof(bad)/sizeof(bad[0]); k++) {
+                converter_input trial = input;
+                converter_result result;
+                unsigned diag;
+                double *fields[9] = {&trial.vin_min, &trial.vin_max, &trial.v_out, &trial.p_out, &trial.f_switch,
+                                     &trial.ripple_v_percent,
+                                     cuk ? &trial.ripple_i_1_percent : &trial.ripple_i_percent,
+                                     cuk ? &trial.ripple_i_2_percent : &trial.ripple_i_percent,
+                                     cuk ? &trial.ripple_v_cn_percent : &trial.ripple_i_percent};
+                *fields[f] = bad[k];
+                if (design(&trial, &result, 1, 0, &diag) != 1 || !(diag & CONV_ERR_NONFINITE)) {rejected = 0;}
+            }
+        }
+        check(rejected, "converter: NaN and infinite inputs are rejected with CONV_ERR_NONFINITE");
+        check(converter_validate(&input) == 0, "converter: test design is valid");
+    }
+}
+
+/* The map fits a quadratic per row. A one point grid (Pout min = Pout max) evaluates the loss
+   equations directly, so every column of a wide map must match it. */
+static void test_loss(void)
+{
+    const loss_params params = {0.05, 2e-8, 2e-8, 0.7, 0.02, 0.01};
+    enum { VIN_POINTS = 5, P_POINTS = 2*LOSS_TILE + 9 };
+    static double eff[VIN_POINTS*P_POINTS];
+    static double eff_serial[VIN_POINTS*P_POINTS];
+    static unsigned char dcm[VIN_POINTS*P_POINTS];
+
+    for (int type = buck_conv; type <= cuk_conv; type++) {
+        converter_input input = test_design((converter_type)type);
+        converter_result result = {0};
+        loss_design design;
+        loss_grid grid = {input.vin_min, input.vin_max, VIN_POINTS, 0.5, input.p_out, P_POINTS};
+        check(converter_design(&input, &result), "loss: test design is valid");
+        loss_build_design(&input, &result, &params, &design);
+        check(loss_efficiency_map(&design, &grid, eff, dcm, 4), "loss: map");
+        check(loss_efficiency_map(&design, &grid, eff_serial, NULL, 1), "loss: serial map");
+        check(memcmp(eff, eff_serial, sizeof(eff)) == 0, "loss: map does not depend on the thread count");
+
+        int fit_ok = 1;
+        int dcm_ok = 1;
+        double vin_step = (grid.vin_hi - grid.vin_lo)/(VIN_POINTS - 1);
+        double p_step = (grid.p_hi - grid.p_lo)/(P_POINTS - 1);
+        for (int row = 0; row < VIN_POINTS; row++) {
+            for (int col = 0; col < P_POINTS; col++) {
+                double p = grid.p_lo + col*p_step;
+                loss_grid point = {grid.vin_lo + row*vin_step, grid.vin_lo + row*vin_step, 1, p, p, 1};
+                double exact;
+                unsigned char exact_dcm;
+                loss_efficiency_map(&design, &point, &exact, &exact_dcm, 1);
+                size_t i = (size_t)row*P_POINTS + col;
+                if (!close_to(eff[i], exact, 1e-9)) {fit_ok = 0;}
+                if (dcm[i] != exact_dcm) {dcm_ok = 0;}
+                //DCM is everything below one boundary power
+                if (col > 0 && dcm[i] > dcm[i - 1]) {dcm_ok = 0;}
+            }
+        }
+        check(fit_ok, "loss: quadratic row fit matches the direct equations");
+        check(dcm_ok, "loss: DCM flags match the direct check and form one light load band");
+        check(dcm[0] == 1 && dcm[P_POINTS - 1] == 0, "loss: 0.5 W is DCM and rated power is CCM");
+
+        loss_params lossless = {0};
+        loss_build_design(&input, &result, &lossless, &design);
+        loss_efficiency_map(&design, &grid, eff, NULL, 1);
+        int unity = 1;
+        for (int i = 0; i < VIN_POINTS*P_POINTS; i++) {
+            if (eff[i] != 1.0) {unity = 0;}
+        }
+        check(unity, "loss: ideal devices give 100 % efficiency");
+    }
+
+    //Vout so far above Vin that D rounds to 1: every loss is infinite and the fit would be inf - inf
+    converter_input steep = {boost_conv, 1, 1, 4e39, 1, 1, 1, 0, 0, 1, 0};
+    converter_result steep_result = {0};
+    loss_design steep_design;
+    loss_grid steep_grid = {1, 1, 1, 0.1, 1, 9};
+    design(&steep, &steep_result, 1, 0, NULL);
+    loss_build_design(&steep, &steep_result, &params, &steep_design);
+    loss_efficiency_map(&steep_design, &steep_grid, eff, NULL, 1);
+    int zero = 1;
+    for (int i = 0; i < 9; i++) {
+        if (eff[i] != 0.0) {zero = 0;}
+    }
+    check(zero, "loss: infinite losses map to 0 % efficiency, not NaN");
+}
+
+/* What the profile model must give at load p: design() of the same L and C at that load, with the
+   DCM duty and peak from IL/ILB = (D/D_ccm)^2 where the model covers DCM */
+static void profile_expected(const converter_input *rated, double p, double *duty, double *peak, unsigned *flags)
+{
+    converter_input input;
+    converter_result result;
+    unsigned diag;
+    profile_input_at(rated, p, &input);
+    design(&input, &result, 1, CONV_NO_VALIDATE, &diag);
+    *duty = result.duty_cycle;
+    *peak = result.i_L_peak;
+    if (!result.is_ccm && rated->type != cuk_conv) {
+        double root = sqrt((result.i_L_peak - result.i_LB)/result.i_LB);
+        *duty = result.duty_cycle*root;
+        *peak = 2.0*result.i_LB*root;
+    }
+    *flags = (!result.is_ccm ? profile_flag_dcm : 0u) | (diag & CONV_WARN_RIPPLE_I ? profile_flag_ripple_i : 0u)
+           | (diag & CONV_WARN_RIPPLE_V ? profile_flag_ripple_v : 0u);
+}
+
+/* One sample per interval, so each line of the interval file is one sample. Checks duty (histogram bin),
+   peak and flags against design(), and that bad samples, an over-long CSV line and a partial binary
+   sample are dropped and reported rather than evaluated. */
+static int profile_check_run(FILE *src, profile_format format, const converter_input *rated,
+                             const double *loads, int count, profile_summary *total)
+{
+    converter_result result = {0};
+    profile_model model;
+    design(rated, &result, 1, 0, NULL);
+    profile_build_model(rated, &result, &model);
+    FILE *out = tmpfile();
+    if (!out || profile_run(src, format, &model, 1.0, 1, out, total) != count) {
+        if (out) {fclose(out);}
+        return 0;
+    }
+    rewind(out);
+    char line[512];
+    int ok = fgets(line, sizeof(line), out) != NULL;    // header
+    for (int i = 0; i < count && ok; i++) {
+        long index, samples, hist[PROFILE_DUTY_BINS];
+        double t, t_dcm, t_ripple_i, t_ripple_v, p_max, peak_max;
+        double duty, peak;
+        unsigned flags;
+        ok = fgets(line, sizeof(line), out) != NULL
+             && sscanf(line, "%ld, %lf, %ld, %lf, %lf, %lf, %lf, %lf, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld, %ld",
+                       &index, &t, &samples, &t_dcm, &t_ripple_i, &t_ripple_v, &p_max, &peak_max,
+                       &hist[0], &hist[1], &hist[2], &hist[3], &hist[4], &hist[5], &hist[6], &hist[7], &hist[8], &hist[9]) == 18;
+        if (!ok) {break;}
+        profile_expected(rated, loads[i], &duty, &peak, &flags);
+        int bin = duty*PROFILE_DUTY_BINS >= PROFILE_DUTY_BINS ? PROFILE_DUTY_BINS - 1 : (int)(duty*PROFILE_DUTY_BINS);
+        ok = samples == 1 && hist[bin] == 1 && fabs(peak_max - peak) <= 0.0005 + 1e-9*peak
+             && (t_dcm == 1.0) == ((flags & profile_flag_dcm) != 0)
+             && (t_ripple_i == 1.0) == ((flags & profile_flag_ripple_i) != 0)
+             && (t_ripple_v == 1.0) == ((flags & profile_flag_ripple_v) != 0);
+    }
+    fclose(out);
+    return ok;
+}
+
+static void test_profile(void)
+{
+    //CCM at and above rated load (6x for the boost output ripple), DCM at the light loads
+    const double scale[] = {1.0, 6.0, 0.5, 0.2, 0.05, 0.01};
+    enum { LOADS = sizeof(scale)/sizeof(scale[0]) };
+    const double bad[] = {NAN, INFINITY, -INFINITY};
+
+    for (int type = buck_conv; type <= cuk_conv; type++) {
+        converter_input rated = test_design((converter_type)type);
+        //unequal ripples, so the worst inductor is not the one with the most current
+        rated.ripple_i_1_percent = 30;
+        rated.ripple_i_2_percent = 10;
+        double loads[LOADS];
+        for (int i = 0; i < LOADS; i++) {loads[i] = scale[i]*rated.p_out;}
+
+        //CSV: header, a bad sample after every good one and a line too long for the read buffer
+        size_t long_line = 70000;
+        size_t size = long_line + 64*LOADS*2 + 64;
+        char *csv = malloc(size);
+        if (!csv) {check(0, "profile: memory"); return;}
+        size_t len = (size_t)sprintf(csv, "time,p_out\n");
+        for (int i = 0; i < LOADS; i++) {
+            len += (size_t)sprintf(csv + len, "%d,%.17g\n%d,%s\n", 2*i, loads[i], 2*i + 1, i == 0 ? "nan" : i == 1 ? "inf" : "-inf");
+            if (i == 2) {
+                memset(csv + len, '7', long_line);
+                len += long_line;
+                len += (size_t)sprintf(csv + len, ",5\n");
+            }
+        }
+        profile_summary total;
+        FILE *src = fmemopen(csv, len, "r");
+        check(src && profile_check_run(src, profile_csv, &rated, loads, LOADS, &total),
+              "profile: CSV samples match design() at their load");
+        check(total.rejected_samples == LOADS && total.skipped_lines == 1 && total.trailing_bytes == 0 && !total.read_error,
+              "profile: CSV non-finite samples rejected and the long line skipped whole");
+        if (src) {fclose(src);}
+        free(csv);
+
+        //Binary: the same loads between non-finite samples, then 3 bytes of a cut off sample
+        unsigned char bin[(2*LOADS)*sizeof(double) + 3] = {0};
+        for (int i = 0; i < LOADS; i++) {
+            memcpy(bin + 2*i*sizeof(double), &loads[i], sizeof(double));
+            memcpy(bin + (2*i + 1)*sizeof(double), &bad[i % 3], sizeof(double));
+        }
+        src = fmemopen(bin, sizeof(bin), "rb");
+        check(src && profile_check_run(src, profile_binary, &rated, loads, LOADS, &total),
+              "profile: binary samples match design() at their load");
+        check(total.rejected_samples == LOADS && total.trailing_bytes == 3 && !total.read_error,
+              "profile: binary non-finite samples rejected and the partial sample reported");
+        if (src) {fclose(src);}
+    }
+}
+
+/* The batched float32 kernel must give the scalar kernel's bits. The audit must measure 0 for
+   double, a float32-sized error for float32, and the tolerance gate must fall back in order. */
+static void test_precision(void)
+{
+    static converter_input inputs[PRECISION_AUDIT_SAMPLES];
+    static converter_result results[PRECISION_BLOCK];
+    static precision_float_block block;
+
+    for (int type = buck_conv; type <= cuk_conv; type++) {
+        converter_input center = test_design((converter_type)type);
+        uint64_t seed = 7;
+        for (int i = 0; i < PRECISION_AUDIT_SAMPLES; i++) {
+            precision_random_input(&center, 0.5, &seed, &inputs[i]);
+        }
+
+        int n = PRECISION_BLOCK - 3;    // the unused lanes are padded by the kernel
+        memset(&block, 0, sizeof(block));
+        block.type = (converter_type)type;
+        block.n = n;
+        for (int i = 0; i < n; i++) {
+            block.vin_min[i] = (float)inputs[i].vin_min;
+            block.vin_max[i] = (float)inputs[i].vin_max;
+            block.v_out[i] = (float)inputs[i].v_out;
+            block.p_out[i] = (float)inputs[i].p_out;
+            block.f_switch[i] = (float)inputs[i].f_switch;
+            block.ripple_i[i] = (float)(type == cuk_conv ? inputs[i].ripple_i_1_percent : inputs[i].ripple_i_percent);
+            block.ripple_i_2[i] = (float)inputs[i].ripple_i_2_percent;
+            block.ripple_v[i] = (float)inputs[i].ripple_v_percent;
+            block.ripple_v_cn[i] = (float)inputs[i].ripple_v_cn_percent;
+        }
+        precision_float_batch(&block);
+        precision_calculate(prec_float, inputs, results, n);
+        int same = 1;
+        for (int i = 0; i < n; i++) {
+            const converter_result *res = &results[i];
+            if (res->duty_cycle != block.duty[i] || res->r_load != block.r_load[i] || res->i_out != block.i_out[i]
+                || res->ripple_i_L != block.ripple_i_L[i] || res->ripple_v_C != block.ripple_v_C[i]) {same = 0;}
+            if (type == cuk_conv) {
+                if (res->L1 != block.L[i] || res->L2 != block.L2[i] || res->Co != block.C[i] || res->Cn != block.Cn[i]) {same = 0;}
+            }
+            else if (res->L != block.L[i] || res->C != block.C[i]) {same = 0;}
+        }
+        check(same, "precision: float32 batch matches the scalar float32 kernel bit for bit");
+
+        precision_report exact, single, fixed, report;
+        precision_audit(prec_double, inputs, PRECISION_AUDIT_SAMPLES, &exact);
+        precision_audit(prec_float, inputs, PRECISION_AUDIT_SAMPLES, &single);
+        precision_audit(prec_fixed, inputs, PRECISION_AUDIT_SAMPLES, &fixed);
+        check(precision_report_max(&exact) == 0, "precision: double audits to zero error");
+        check(precision_report_max(&single) > 0 && precision_report_max(&single) < 1e-5,
+              "precision: float32 error is a few float32 ulps");
+        check(single.samples == PRECISION_AUDIT_SAMPLES && single.mode == prec_float, "precision: report header");
+
+        check(precision_select(prec_fixed, inputs, PRECISION_AUDIT_SAMPLES, 1.0, &report) == prec_fixed,
+              "precision: fixed-point within a loose tolerance is kept");
+        check(precision_select(prec_float, inputs, PRECISION_AUDIT_SAMPLES, 0, &report) == prec_double
+              && report.mode == prec_double && report.samples == 0 && precision_report_max(&report) == 0,
+              "precision: nothing within zero tolerance, double with an empty report");
+        if (precision_report_max(&single) < precision_report_max(&fixed)) {
+            double between = precision_report_max(&single);
+            check(precision_select(prec_fixed, inputs, PRECISION_AUDIT_SAMPLES, between, &report) == prec_float
+                  && report.mode == prec_float, "precision: fixed-point outside tolerance falls back to float32");
+        }
+    }
+
+    //1 - D cancelled in float32 when Vout >> Vin, L went to 0
+    converter_input tiny = test_design(buck_boost_conv);
+    converter_result reference = {0};
+    converter_result single = {0};
+    tiny.vin_min = 2e-5;
+    tiny.vin_max = 2e-5;
+    tiny.v_out = 1000;
+    converter_calculate(&tiny, &reference);
+    precision_calculate(prec_float, &tiny, &single, 1);
+    check(close_to(single.L, reference.L, 1e-5), "precision: float32 1 - D does not cancel for Vout >> Vin");
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+static void archive_write_designs(FILE *fp, long n, uint64_t *seed)
+{
+    converter_input center = test_design(buck_conv);
+    converter_input input;
+    for (long i = 0; i < n; i++) {
+        precision_random_input(&center, 0.5, seed, &input);
+        fprintf(fp, "BUCK, Vin_min=%.6f, Vin_max=%.6f, Vout=%.6f, Pout=%.6f, f_sw=%.3f, L=0, C=0\n",
+                input.vin_min, input.vin_max, input.v_out, input.p_out, input.f_switch);
+    }
+}
+
+/* Main tree, recent tree and tail are all searched: k nearest and the tolerance box must give the
+   distances a linear scan over every record gives. A refresh must not get past a half written line. */
+static void test_archive(void)
+{
+    enum { QUERIES = 50, SHOW = 20 };
+    char path[] = "/tmp/archive_testXXXXXX";
+    int fd = mkstemp(path);
+    FILE *fp = fd < 0 ? NULL : fdopen(fd, "w");
+    check(fp != NULL, "archive: temporary file");
+    if (!fp) {return;}
+
+    archive_index index;
+    archive_init(&index, buck_conv, path);
+    uint64_t seed = 11;
+    //40000 build the main tree, 4500 (< 1/8 of it) the recent tree and 1000 stay in the tail
+    const long batch[] = {40000, 4500, 1000};
+    for (int b = 0; b < 3; b++) {
+        archive_write_designs(fp, batch[b], &seed);
+        fflush(fp);
+        check(archive_refresh(&index) == batch[b], "archive: refresh reads every new design");
+    }
+    check(index.built == 40000 && index.recent == 44500 && index.count == 45500,
+          "archive: main tree, recent tree and tail");
+
+    static double linear[45500];
+    static double in_box[45500];
+    archive_match match[ARCHIVE_MAX_K];
+    converter_input center = test_design(buck_conv);
+    int nearest_ok = 1;
+    int range_ok = 1;
+    for (int q = 0; q < QUERIES; q++) {
+        converter_input spec;
+        double key[ARCHIVE_DIMS];
+        precision_random_input(&center, 0.5, &seed, &spec);
+        archive_key(&spec, key);
+        double radius = log10(1.0 + 0.05*(q % 6 + 1));
+        long boxed = 0;
+        for (long i = 0; i < index.count; i++) {
+            double d2 = 0;
+            int inside = 1;
+            for (int d = 0; d < ARCHIVE_DIMS; d++) {
+                double diff = index.record[i].key[d] - key[d];
+                d2 += diff*diff;
+                if (fabs(diff) > radius) {inside = 0;}
+            }
+            linear[i] = sqrt(d2);
+            if (inside) {in_box[boxed++] = linear[i];}
+        }
+        qsort(linear, (size_t)index.count, sizeof(linear[0]), compare_double);
+        qsort(in_box, (size_t)boxed, sizeof(in_box[0]), compare_double);
+
+        int k = q % ARCHIVE_MAX_K + 1;
+        int found = archive_nearest(&index, key, k, match);
+        if (found != k) {nearest_ok = 0;}
+        for (int i = 0; i < found; i++) {
+            if (match[i].distance != linear[i]) {nearest_ok = 0;}
+        }
+
+        long total = archive_range(&index, key, 0.05*(q % 6 + 1), match, SHOW);
+        long shown = total < SHOW ? total : SHOW;
+        if (total != boxed) {range_ok = 0;}
+        double kept[SHOW];
+        for (long i = 0; i < shown; i++) {kept[i] = match[i].distance;}
+        qsort(kept, (size_t)shown, sizeof(kept[0]), compare_double);
+        for (long i = 0; i < shown; i++) {
+            if (kept[i] != in_box[i]) {range_ok = 0;}
+        }
+    }
+    check(nearest_ok, "archive: k nearest match a linear scan");
+    check(range_ok, "archive: tolerance search counts like a linear scan and keeps the nearest");
+    archive_free(&index);
+
+    //A half written line, too long for the line buffer, is left for the next refresh
+    fp = freopen(path, "w", fp);
+    check(fp != NULL, "archive: temporary file");
+    if (!fp) {unlink(path); return;}
+    archive_init(&index, buck_conv, path);
+    archive_write_designs(fp, 2, &seed);
+    long complete = ftell(fp);
+    fprintf(fp, "BUCK, Vin_min=40.000000, ");
+    for (int i = 0; i < ARCHIVE_LINE; i++) {fputc('0', fp);}
+    fflush(fp);
+    check(archive_refresh(&index) == 2 && index.file_bytes == complete && index.skipped == 0,
+          "archive: refresh stops at a half written long line");
+    fprintf(fp, "\n");
+    archive_write_designs(fp, 1, &seed);
+    fflush(fp);
+    check(archive_refresh(&index) == 1 && index.file_bytes == ftell(fp) && index.skipped == 1,
+          "archive: the finished long line is skipped and the next one read");
+    archive_free(&index);
+    fclose(fp);
+    unlink(path);
+}
+
+/* Every core, every turn count and the wire with the most copper that fits, without any bounds.
+   Fills best with the lowest loss design, or the lowest loss one on the smallest core for min_volume. */
+static int mag_exhaustive(const mag_db *db, const mag_limits *limits, const mag_inductor *inductor, mag_choice *best)
+{
+    const double L = inductor->L;
+    double i_rms_sq = inductor->i_avg*inductor->i_avg + inductor->ripple*inductor->ripple/12.0;
+    double copper_min = sqrt(i_rms_sq)/limits->j_max;
+    best->core = -1;
+    best->p_total = INFINITY;
+    best->volume = INFINITY;
+    for (int c = 0; c < db->cores; c++) {
+        const mag_core *core = &db->core[c];
+        double volume = core->ae*core->le;
+        double ae = core->ae*1e-6;
+        double al = core->al*1e-9;
+        double window = MAG_FILL*core->wa;
+        double pv_1 = core->k*pow(inductor->f_switch, core->alpha)*pow(L*inductor->ripple/(2.0*ae), core->beta)*volume*1e-9;
+        for (int n = 1; n <= MAG_MAX_TURNS; n++) {
+            //A gap can only lower AL, a fixed AL core has to reach L
+            if (n < sqrt(L/al)*(1.0 - 1e-12)) {continue;}
+            double L_wound = core->gapped ? L : al*n*n;
+            double ripple = inductor->ripple*L/L_wound;
+            if (L_wound*(inductor->i_avg + ripple/2.0)/(n*ae) > MAG_B_MARGIN*core->b_sat) {continue;}
+            double copper = 0;
+            for (int w = 0; w < db->wires; w++) {
+                if (db->wire[w].area*n <= window && db->wire[w].copper >= copper_min && db->wire[w].copper > copper) {
+                    copper = db->wire[w].copper;
+                }
+            }
+            if (copper == 0) {continue;}
+            double rms_sq = inductor->i_avg*inductor->i_avg + ripple*ripple/12.0;
+            double p_total = rms_sq*MAG_RHO_CU*n*core->mlt/copper + pv_1*pow(n, -core->beta);
+            int better = best->core < 0 || p_total < best->p_total;
+            if (limits->objective == mag_min_volume && best->core >= 0 && volume != best->volume) {
+                better = volume < best->volume;
+            }
+            if (better) {
+                best->core = c;
+                best->turns = n;
+                best->p_total = p_total;
+                best->volume = volume;
+            }
+        }
+    }
+    return best->core >= 0;
+}
+
+/* The pruned search must find the same optimum as trying everything, over cores.txt */
+static void test_magnetics(void)
+{
+    static mag_db db;
+    check(mag_load_db(MAG_DB, &db), "magnetics: " MAG_DB " loads");
+    if (db.cores == 0) {return;}
+
+    const double j_max[] = {3, 8};
+    int same = 1;
+    int found = 0;
+    int searched = 0;
+    uint64_t seed = 5;
+    for (int type = buck_conv; type <= cuk_conv; type++) {
+        converter_input center = test_design((converter_type)type);
+        for (int i = 0; i < 6; i++) {
+            converter_input input;
+            converter_result result;
+            mag_inductor inductor[2];
+            precision_random_input(&center, 0.8, &seed, &input);
+            if (design(&input, &result, 1, 0, NULL) != 0) {continue;}
+            int count = mag_inductors(&input, &result, inductor);
+            for (int l = 0; l < count; l++) {
+                for (size_t j = 0; j < sizeof(j_max)/sizeof(j_max[0]); j++) {
+                    for (int objective = mag_min_loss; objective <= mag_min_volume; objective++) {
+                        mag_limits limits = {j_max[j], (mag_objective)objective};
+                        mag_choice pruned, exhaustive;
+                        int ok = mag_search(&db, &limits, &inductor[l], &pruned, NULL);
+                        if (ok != mag_exhaustive(&db, &limits, &inductor[l], &exhaustive)) {same = 0;}
+                        else if (ok && (!close_to(pruned.p_total, exhaustive.p_total, 1e-12)
+                                        || pruned.volume != exhaustive.volume)) {same = 0;}
+                        found += ok;
+                        searched++;
+                    }
+                }
+            }
+        }
+    }
+    check(same, "magnetics: pruned search finds the exhaustive optimum");
+    check(found > searched/2, "magnetics: most test inductors find a core");
+}
+
+int main(void)
+{
+    test_converter();
+    test_loss();
+    test_precision();
+    test_profile();
+    test_archive();
+    test_magnetics();
+    printf("%d of %d checks passed\n", checks - failed, checks);
+    return failed != 0;
+}
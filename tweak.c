@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include "tweak.h"
+#include "converter_eq.h"
+//Tweak mode: keep one design live and change one parameter at a time.
+//Each topology is a small graph of its equations, so only the fields downstream of the change are
+//recomputed, and a field whose value did not change stops the walk (early cutoff).
+//The equations are the ones converter.c uses, from converter_eq.h, so the results are bit for bit equal.
+
+#define N(i) (1u << (i))
+#define OFF(field) offsetof(converter_result, field)
+
+typedef struct {
+    const char *name;
+    unsigned bit;
+    size_t offset;        // field in converter_input
+} tweak_param;
+
+static const tweak_param params[] = {
+    {"vin_min",     TWEAK_VIN_MIN,     offsetof(converter_input, vin_min)},
+    {"vin_max",     TWEAK_VIN_MAX,     offsetof(converter_input, vin_max)},
+    {"v_out",       TWEAK_V_OUT,       offsetof(converter_input, v_out)},
+    {"p_out",       TWEAK_P_OUT,       offsetof(converter_input, p_out)},
+    {"f_switch",    TWEAK_F_SWITCH,    offsetof(converter_input, f_switch)},
+    {"ripple_i",    TWEAK_RIPPLE_I,    offsetof(converter_input, ripple_i_percent)},
+    {"ripple_i_1",  TWEAK_RIPPLE_I_1,  offsetof(converter_input, ripple_i_1_percent)},
+    {"ripple_i_2",  TWEAK_RIPPLE_I_2,  offsetof(converter_input, ripple_i_2_percent)},
+    {"ripple_v",    TWEAK_RIPPLE_V,    offsetof(converter_input, ripple_v_percent)},
+    {"ripple_v_cn", TWEAK_RIPPLE_V_CN, offsetof(converter_input, ripple_v_cn_percent)},
+};
+#define PARAM_COUNT ((int)(sizeof(params)/sizeof(params[0])))
+
+static int  tweak_read_command(converter_input *input, converter_result *result);
+static void tweak_print_diff(const tweak_graph *graph, const converter_result *old_result, const converter_result *new_result, unsigned node_changed);
+static void tweak_print_design(const converter_input *input, const converter_result *result);
+static double node_value(const tweak_node *node, const converter_result *result);
+static long elapsed_ns(const struct timespec *start, const struct timespec *end);
+
+//BUCK CONVERTER
+enum {BK_D, BK_R, BK_IOUT, BK_DIL, BK_L, BK_DVC, BK_C, BK_ILB, BK_PEAK, BK_CCM};
+
+static const tweak_node buck_nodes[] = {
+    {"D",        "",    OFF(duty_cycle), 0, TWEAK_VIN_MIN | TWEAK_V_OUT,                  0,                         buck_eq_d},
+    {"R_load",   "Ohm", OFF(r_load),     0, TWEAK_V_OUT | TWEAK_P_OUT,                    0,                         buck_eq_r},
+    {"Iout",     "A",   OFF(i_out),      0, TWEAK_V_OUT,                                  N(BK_R),                   buck_eq_iout},
+    {"delta IL", "A",   OFF(ripple_i_L), 0, TWEAK_RIPPLE_I,                               N(BK_IOUT),                buck_eq_dil},
+    {"L",        "H",   OFF(L),          0, TWEAK_VIN_MAX | TWEAK_V_OUT | TWEAK_F_SWITCH, N(BK_D) | N(BK_DIL),       buck_eq_l},
+    {"delta Vc", "V",   OFF(ripple_v_C), 0, TWEAK_RIPPLE_V | TWEAK_V_OUT,                 0,                         buck_eq_dvc},
+    {"C",        "F",   OFF(C),          0, TWEAK_F_SWITCH,                               N(BK_DIL) | N(BK_DVC),     buck_eq_c},
+    {"ILB",      "A",   OFF(i_LB),       0, 0,                                            N(BK_DIL),                 buck_eq_ilb},
+    {"IL peak",  "A",   OFF(i_L_peak),   0, 0,                                            N(BK_IOUT) | N(BK_DIL),    buck_eq_peak},
+    {"mode",     "",    OFF(is_ccm),     1, 0,                                            N(BK_IOUT) | N(BK_ILB),    buck_eq_ccm},
+};
+
+//Boost converter
+enum {BS_D, BS_R, BS_IOUT, BS_DIL, BS_L, BS_DVC, BS_C, BS_ILB, BS_PEAK, BS_CCM};
+
+static const tweak_node boost_nodes[] = {
+    {"D",        "",    OFF(duty_cycle), 0, TWEAK_VIN_MIN | TWEAK_V_OUT,                   0,                                  boost_eq_d},
+    {"R_load",   "Ohm", OFF(r_load),     0, TWEAK_V_OUT | TWEAK_P_OUT,                     0,                                  boost_eq_r},
+    {"Iout",     "A",   OFF(i_out),      0, TWEAK_P_OUT | TWEAK_V_OUT,                     0,                                  boost_eq_iout},
+    {"delta IL", "A",   OFF(ripple_i_L), 0, TWEAK_RIPPLE_I | TWEAK_P_OUT | TWEAK_VIN_MIN,  0,                                  boost_eq_dil},
+    {"L",        "H",   OFF(L),          0, TWEAK_VIN_MIN | TWEAK_F_SWITCH,                N(BS_D) | N(BS_DIL),                boost_eq_l},
+    {"delta Vc", "V",   OFF(ripple_v_C), 0, TWEAK_RIPPLE_V | TWEAK_V_OUT,                  0,                                  boost_eq_dvc},
+    {"C",        "F",   OFF(C),          0, TWEAK_F_SWITCH,                                N(BS_IOUT) | N(BS_D) | N(BS_DVC),   boost_eq_c},
+    {"ILB",      "A",   OFF(i_LB),       0, 0,                                             N(BS_DIL),                          boost_eq_ilb},
+    {"IL peak",  "A",   OFF(i_L_peak),   0, TWEAK_P_OUT | TWEAK_VIN_MIN,                   N(BS_DIL),                          boost_eq_peak},
+    {"mode",     "",    OFF(is_ccm),     1, TWEAK_P_OUT | TWEAK_VIN_MIN,                   N(BS_ILB),                          boost_eq_ccm},
+};
+
+//Buck_Boost Converter
+enum {BB_D, BB_IOUT, BB_R, BB_DIL, BB_L, BB_DVC, BB_C, BB_ILB, BB_PEAK, BB_CCM};
+
+static const tweak_node buck_boost_nodes[] = {
+    {"D",        "",    OFF(duty_cycle), 0, TWEAK_V_OUT | TWEAK_VIN_MIN,   0,                                  buck_boost_eq_d},
+    {"Iout",     "A",   OFF(i_out),      0, TWEAK_P_OUT | TWEAK_V_OUT,     0,                                  buck_boost_eq_iout},
+    {"R_load",   "Ohm", OFF(r_load),     0, TWEAK_V_OUT | TWEAK_P_OUT,     0,                                  buck_boost_eq_r},
+    {"delta IL", "A",   OFF(ripple_i_L), 0, TWEAK_RIPPLE_I,                N(BB_IOUT) | N(BB_D),               buck_boost_eq_dil},
+    {"L",        "H",   OFF(L),          0, TWEAK_VIN_MIN | TWEAK_F_SWITCH, N(BB_D) | N(BB_DIL),               buck_boost_eq_l},
+    {"delta Vc", "V",   OFF(ripple_v_C), 0, TWEAK_RIPPLE_V | TWEAK_V_OUT,  0,                                  buck_boost_eq_dvc},
+    {"C",        "F",   OFF(C),          0, TWEAK_F_SWITCH,                N(BB_IOUT) | N(BB_D) | N(BB_DVC),   buck_boost_eq_c},
+    {"ILB",      "A",   OFF(i_LB),       0, 0,                             N(BB_DIL),                          buck_boost_eq_ilb},
+    {"IL peak",  "A",   OFF(i_L_peak),   0, 0,                             N(BB_IOUT) | N(BB_D) | N(BB_DIL),   buck_boost_eq_peak},
+    {"mode",     "",    OFF(is_ccm),     1, 0,                             N(BB_IOUT) | N(BB_D) | N(BB_ILB),   buck_boost_eq_ccm},
+};
+
+//CUK CONVERTER
+enum {CK_D, CK_R, CK_IOUT, CK_L1, CK_L2, CK_CO, CK_CN, CK_ILB, CK_PEAK, CK_CCM};
+
+#define CUK_RIPPLE_I (TWEAK_P_OUT | TWEAK_VIN_MIN | TWEAK_RIPPLE_I_1 | TWEAK_RIPPLE_I_2)
+
+static const tweak_node cuk_nodes[] = {
+    {"D",        "",    OFF(duty_cycle), 0, TWEAK_V_OUT | TWEAK_VIN_MIN,                                          0,                                    cuk_eq_d},
+    {"R_load",   "Ohm", OFF(r_load),     0, TWEAK_V_OUT | TWEAK_P_OUT,                                            0,                                    cuk_eq_r},
+    {"Iout",     "A",   OFF(i_out),      0, TWEAK_P_OUT | TWEAK_V_OUT,                                            0,                                    cuk_eq_iout},
+    {"L1",       "H",   OFF(L1),         0, TWEAK_VIN_MIN | TWEAK_F_SWITCH | TWEAK_P_OUT | TWEAK_RIPPLE_I_1,      N(CK_D),                              cuk_eq_l1},
+    {"L2",       "H",   OFF(L2),         0, TWEAK_V_OUT | TWEAK_F_SWITCH | TWEAK_RIPPLE_I_2,                      N(CK_D) | N(CK_IOUT),                 cuk_eq_l2},
+    {"Co",       "F",   OFF(Co),         0, TWEAK_V_OUT | TWEAK_F_SWITCH | TWEAK_RIPPLE_V,                        N(CK_D) | N(CK_L2),                   cuk_eq_co},
+    {"Cn",       "F",   OFF(Cn),         0, TWEAK_F_SWITCH | TWEAK_VIN_MIN | TWEAK_RIPPLE_V_CN,                   N(CK_D) | N(CK_IOUT),                 cuk_eq_cn},
+    {"ILB",      "A",   OFF(i_LB),       0, CUK_RIPPLE_I,                                                         N(CK_IOUT),                           cuk_eq_ilb},
+    {"IL peak",  "A",   OFF(i_L_peak),   0, TWEAK_P_OUT | TWEAK_VIN_MIN,                                          N(CK_IOUT) | N(CK_ILB),               cuk_eq_peak},
+    {"mode",     "",    OFF(is_ccm),     1, TWEAK_P_OUT | TWEAK_VIN_MIN,                                          N(CK_IOUT) | N(CK_ILB),               cuk_eq_ccm},
+};
+
+#define COMMON_INPUTS (TWEAK_VIN_MIN | TWEAK_VIN_MAX | TWEAK_V_OUT | TWEAK_P_OUT | TWEAK_F_SWITCH | TWEAK_RIPPLE_V)
+
+static const tweak_graph graphs[] = {
+    {buck_nodes,       (int)(sizeof(buck_nodes)/sizeof(buck_nodes[0])),             COMMON_INPUTS | TWEAK_RIPPLE_I},
+    {boost_nodes,      (int)(sizeof(boost_nodes)/sizeof(boost_nodes[0])),           COMMON_INPUTS | TWEAK_RIPPLE_I},
+    {buck_boost_nodes, (int)(sizeof(buck_boost_nodes)/sizeof(buck_boost_nodes[0])), COMMON_INPUTS | TWEAK_RIPPLE_I},
+    {cuk_nodes,        (int)(sizeof(cuk_nodes)/sizeof(cuk_nodes[0])),               COMMON_INPUTS | TWEAK_RIPPLE_I_1 | TWEAK_RIPPLE_I_2 | TWEAK_RIPPLE_V_CN},
+};
+
+void tweak_design(void) {
+    converter_input input = {0};
+    converter_result result = {0};
+
+    printf("\n>> Tweak Design\n");
+    if (!converter_read_design(&input, &result)) {
+        return;
+    }
+    tweak_print_design(&input, &result);
+    printf("\nChange one parameter at a time as name=value, e.g. f_switch=200000.\n");
+    printf("Enter 'show' to print the design, 'q' to finish.\n");
+    while (tweak_read_command(&input, &result)) {}
+}
+
+const tweak_graph *tweak_graph_for(converter_type type) {
+    if ((unsigned)type >= sizeof(graphs)/sizeof(graphs[0])) {
+        return NULL;
+    }
+    return &graphs[type];
+}
+
+unsigned tweak_param_bit(const char *name) {
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        if (strcmp(params[i].name, name) == 0) {
+            return params[i].bit;
+        }
+    }
+    return 0;
+}
+
+//Set one input parameter by name. Return its TWEAK_ bit, 0 if the name is unknown.
+int tweak_set_param(converter_input *input, const char *name, double value) {
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        if (strcmp(params[i].name, name) == 0) {
+            *(double *)((char *)input + params[i].offset) = value;
+            return (int)params[i].bit;
+        }
+    }
+    return 0;
+}
+
+//Bring result up to date after the input parameters in changed were set. result must be the design
+//before the change. node_changed (may be NULL) gets the bits of the nodes whose value changed.
+//Return the number of nodes evaluated, -1 for an unknown topology.
+int tweak_recompute(const converter_input *input, converter_result *result, unsigned changed, unsigned *node_changed) {
+    const tweak_graph *graph = tweak_graph_for(input->type);
+    if (!graph) {
+        return -1;
+    }
+    unsigned dirty = 0;
+    int evaluated = 0;
+    for (int i = 0; i < graph->count; i++) {
+        const tweak_node *node = &graph->node[i];
+        if (!(node->inputs & changed) && !(node->nodes & dirty)) {
+            continue;
+        }
+        double old_value = node_value(node, result);
+        double new_value = node->eval(input, result);
+        char *field = (char *)result + node->offset;
+        if (node->is_int) {*(int *)field = (int)new_value;}
+        else {*(double *)field = new_value;}
+        if (new_value != old_value) {
+            dirty |= N(i);
+        }
+        evaluated++;
+    }
+    if (node_changed) {*node_changed = dirty;}
+    return evaluated;
+}
+
+//Read and apply one command. Return 0 when the user is done.
+static int tweak_read_command(converter_input *input, converter_result *result) {
+    const tweak_graph *graph = tweak_graph_for(input->type);
+    char command[64];
+    printf("\nTweak (name=value, show, q): ");
+    if (scanf("%63s", command) != 1) {
+        return 0;
+    }
+    if (strcmp(command, "q") == 0 || strcmp(command, "Q") == 0) {
+        return 0;
+    }
+    if (strcmp(command, "show") == 0) {
+        tweak_print_design(input, result);
+        return 1;
+    }
+
+    char *equals = strchr(command, '=');
+    char *end;
+    if (!equals) {
+        printf("ERROR: Expected name=value!\n");
+        return 1;
+    }
+    *equals = '\0';
+    double value = strtod(equals + 1, &end);
+    if (end == equals + 1 || *end != '\0') {
+        printf("ERROR: '%s' is not a number!\n", equals + 1);
+        return 1;
+    }
+    unsigned bit = tweak_param_bit(command);
+    if (!bit || !(bit & graph->inputs)) {
+        printf("ERROR: This topology has no parameter '%s'!\n", command);
+        return 1;
+    }
+
+    //Check the whole input before touching the design, so a bad value leaves it as it was
+    converter_input trial = *input;
+    tweak_set_param(&trial, command, value);
+    unsigned diag = converter_validate(&trial);
+    if (diag & CONV_ERR_MASK) {
+        printf("ERROR: %s=%g gives an invalid design, change ignored!\n", command, value);
+        return 1;
+    }
+
+    converter_result old_result = *result;
+    unsigned node_changed;
+    struct timespec start, end_time;
+    *input = trial;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int evaluated = tweak_recompute(input, result, bit, &node_changed);
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+
+    tweak_print_diff(graph, &old_result, result, node_changed);
+    printf("(%d of %d fields recomputed in %ld ns)\n", evaluated, graph->count, elapsed_ns(&start, &end_time));
+    //The warnings of the new design, the same ones the design menus print
+    converter_print_warnings(input->type, converter_warnings(input, result));
+    return 1;
+}
+
+static void tweak_print_diff(const tweak_graph *graph, const converter_result *old_result, const converter_result *new_result, unsigned node_changed) {
+    if (!node_changed) {
+        printf("No change in the design.\n");
+        return;
+    }
+    for (int i = 0; i < graph->count; i++) {
+        const tweak_node *node = &graph->node[i];
+        if (!(node_changed & N(i))) {
+            continue;
+        }
+        if (node->is_int) {
+            printf("%-9s: %s -> %s\n", node->name, node_value(node, old_result) ? "CCM" : "DCM", node_value(node, new_result) ? "CCM" : "DCM");
+        }
+        else {
+            printf("%-9s: %.6e -> %.6e%s%s\n", node->name, node_value(node, old_result), node_value(node, new_result), *node->unit ? " " : "", node->unit);
+        }
+    }
+}
+
+static void tweak_print_design(const converter_input *input, const converter_result *result) {
+    const tweak_graph *graph = tweak_graph_for(input->type);
+    printf("\nParameters:");
+    for (int i = 0; i < PARAM_COUNT; i++) {
+        if (params[i].bit & graph->inputs) {
+            printf(" %s=%g", params[i].name, *(const double *)((const char *)input + params[i].offset));
+        }
+    }
+    printf("\n");
+    for (int i = 0; i < graph->count; i++) {
+        const tweak_node *node = &graph->node[i];
+        if (node->is_int) {printf("%-9s= %s\n", node->name, node_value(node, result) ? "CCM" : "DCM");}
+        else {printf("%-9s= %.6e%s%s\n", node->name, node_value(node, result), *node->unit ? " " : "", node->unit);}
+    }
+}
+
+static double node_value(const tweak_node *node, const converter_result *result) {
+    const char *field = (const char *)result + node->offset;
+    if (node->is_int) {return *(const int *)field;}
+    return *(const double *)field;
+}
+
+static long elapsed_ns(const struct timespec *start, const struct timespec *end) {
+    return (end->tv_sec - start->tv_sec)*1000000000L + (end->tv_nsec - start->tv_nsec);
+}
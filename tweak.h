@@ -0,0 +1,44 @@
+#ifndef TWEAK_H
+#define TWEAK_H
+
+#include "funcs.h"
+
+//Input parameters, one bit each
+#define TWEAK_VIN_MIN      0x001u
+#define TWEAK_VIN_MAX      0x002u
+#define TWEAK_V_OUT        0x004u
+#define TWEAK_P_OUT        0x008u
+#define TWEAK_F_SWITCH     0x010u
+#define TWEAK_RIPPLE_I     0x020u
+#define TWEAK_RIPPLE_I_1   0x040u
+#define TWEAK_RIPPLE_I_2   0x080u
+#define TWEAK_RIPPLE_V     0x100u
+#define TWEAK_RIPPLE_V_CN  0x200u
+
+#define TWEAK_MAX_NODES    16
+
+//One equation of a topology: a result field, what it reads and how to evaluate it.
+//Nodes are listed in evaluation order, so a node only reads nodes before it.
+typedef struct {
+    const char *name;
+    const char *unit;
+    size_t offset;        // field in converter_result
+    int is_int;           // is_ccm is stored as int
+    unsigned inputs;      // TWEAK_ bits of the input parameters it reads
+    unsigned nodes;       // bits of the earlier nodes it reads
+    double (*eval)(const converter_input *input, const converter_result *result);
+} tweak_node;
+
+typedef struct {
+    const tweak_node *node;
+    int count;
+    unsigned inputs;      // TWEAK_ bits the topology takes, some are only validated (vin_max)
+} tweak_graph;
+
+void tweak_design(void);
+const tweak_graph *tweak_graph_for(converter_type type);
+unsigned tweak_param_bit(const char *name);
+int tweak_set_param(converter_input *input, const char *name, double value);
+int tweak_recompute(const converter_input *input, converter_result *result, unsigned changed, unsigned *node_changed);
+
+#endif